@@ -0,0 +1,154 @@
+#include "bench.hpp"
+#include "ecs.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <memory_resource>
+#include <new>
+
+// Every global allocation in the benchmark binary goes through these, so a frame's allocations can be counted. Only
+// the allocation suite turns counting on, so the other suites' timings don't pay for a shared atomic counter. GCC
+// can't tell that the pointers freed here came from malloc.
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+
+static std::atomic<bool> counting_allocations = false;
+static std::atomic<std::size_t> global_allocations = 0;
+
+static void count_allocation() {
+    if(counting_allocations.load(std::memory_order_relaxed)) {
+        global_allocations.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void* operator new(std::size_t size) {
+    count_allocation();
+    if(void* pointer = std::malloc(size ? size : 1)) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    count_allocation();
+    std::size_t align = (std::size_t)alignment;
+    if(void* pointer = std::aligned_alloc(align, (size + align - 1) / align * align)) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept {
+    operator delete(pointer);
+}
+
+void operator delete(void* pointer, std::align_val_t) noexcept {
+    operator delete(pointer);
+}
+
+void operator delete(void* pointer, std::size_t, std::align_val_t) noexcept {
+    operator delete(pointer);
+}
+
+namespace {
+    typedef struct Lifetime {
+        int frames;
+    } Lifetime;
+}
+
+// A frame of a bullet hell: every bullet moves, a wave of new bullets is spawned and the expired ones are removed
+static void run_frame(ecs::ECS& ecs, ecs::CommandBuffer& commands, int frame) {
+    const int SPAWNED_PER_FRAME = 256;
+
+    ecs.view<Position, const Velocity>().each([](Position& position, const Velocity& velocity) {
+        position.x += velocity.x;
+        position.y += velocity.y;
+    });
+
+    ecs.view<Lifetime>().each([&commands](ecs::Entity e, Lifetime& lifetime) {
+        if(--lifetime.frames == 0) {
+            commands.remove_entity(e);
+        }
+    });
+
+    for(int i = 0; i < SPAWNED_PER_FRAME; i++) {
+        ecs::Entity bullet = commands.create_entity();
+        commands.add_component<Position>(bullet, (Position) { .x = 0.0f, .y = 0.0f });
+        commands.add_component<Velocity>(bullet, (Velocity) { .x = (float)i, .y = (float)frame });
+        commands.add_component<Lifetime>(bullet, (Lifetime) { .frames = 32 + i % 32 });
+    }
+
+    commands.flush();
+    ecs.advance_tick();
+}
+
+// Runs warmup frames until every buffer has reached its steady state size, then counts the global allocations made
+// by the measured frames. With allocation_free set, the run fails if the measured frames allocated at all.
+static void benchmark_frames(const std::string& name, std::pmr::memory_resource* resource, bool allocation_free) {
+    const int WARMUP_FRAMES = 256;
+    const int MEASURED_FRAMES = 1024;
+
+    ecs::ECS ecs(0, resource);
+    ecs.register_component<Position>();
+    ecs.register_component<Velocity>();
+    ecs.register_component<Lifetime>();
+    ecs::CommandBuffer commands(ecs);
+
+    for(int frame = 0; frame < WARMUP_FRAMES; frame++) {
+        run_frame(ecs, commands, frame);
+    }
+
+    std::size_t allocations_before = global_allocations.load();
+    double frames_ns = bench::time_ns([&]() {
+        for(int frame = 0; frame < MEASURED_FRAMES; frame++) {
+            run_frame(ecs, commands, frame);
+        }
+    });
+    std::size_t allocations = global_allocations.load() - allocations_before;
+
+    bench::report(name + " steady state frame", frames_ns / MEASURED_FRAMES);
+    bench::report(name + " global allocations per frame", (double)allocations / MEASURED_FRAMES, "allocations/op");
+    if(allocation_free) {
+        bench::check(allocations == 0, name + " made " + std::to_string(allocations) + " global allocations in steady state frames.");
+    }
+}
+
+void run_allocation_benchmarks() {
+    counting_allocations = true;
+
+    // The default resource's free slot deque still allocates as it churns through blocks
+    benchmark_frames("default resource", std::pmr::get_default_resource(), false);
+
+    std::pmr::unsynchronized_pool_resource pool;
+    benchmark_frames("unsynchronized_pool_resource", &pool, true);
+
+    // Throwaway worlds can live in an arena which is released all at once
+    const int WORLD_COUNT = 2000;
+    const int ENTITY_COUNT = 64;
+    std::size_t allocations_before = global_allocations.load();
+    std::byte buffer[64 * 1024];
+    double arena_ns = bench::time_ns([&]() {
+        for(int world = 0; world < WORLD_COUNT; world++) {
+            std::pmr::monotonic_buffer_resource arena(buffer, sizeof(buffer), std::pmr::null_memory_resource());
+            ecs::ECS ecs(ENTITY_COUNT, &arena);
+            ecs.register_component<Position>();
+            ecs.register_component<Velocity>();
+            for(int i = 0; i < ENTITY_COUNT; i++) {
+                ecs::Entity e = ecs.create_entity();
+                ecs.add_component<Position>(e, (Position) { .x = (float)i, .y = 0.0f });
+                ecs.add_component<Velocity>(e, (Velocity) { .x = 1.0f, .y = 0.0f });
+            }
+            bench::do_not_optimize(ecs);
+        }
+    });
+    std::size_t arena_allocations = global_allocations.load() - allocations_before;
+
+    bench::report("world with 64 entities in a monotonic arena, create and destroy", arena_ns / WORLD_COUNT);
+    bench::report("world in a monotonic arena global allocations per world", (double)arena_allocations / WORLD_COUNT, "allocations/op");
+    bench::check(arena_allocations == 0, "Worlds in a monotonic arena made " + std::to_string(arena_allocations) + " global allocations.");
+
+    counting_allocations = false;
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace bench {
+    // Prevents the compiler from optimizing away a value computed by a benchmark
+    template<typename T>
+    inline void do_not_optimize(T const& value) {
+        asm volatile("" : : "r,m"(value) : "memory");
+    }
+
+    // Runs the function once and returns how many nanoseconds it took
+    template<typename F>
+    double time_ns(F&& function) {
+        auto start = std::chrono::steady_clock::now();
+        function();
+        auto end = std::chrono::steady_clock::now();
+
+        return std::chrono::duration<double, std::nano>(end - start).count();
+    }
+
+    typedef struct Result {
+        std::string name;
+        double value;
+        std::string unit;
+
+        // The number of threads the result was measured with, or 0 if it ran on the calling thread only
+        std::size_t threads;
+    } Result;
+
+    // Every reported result, in the order they were reported, for writing to a JSON file at the end of the run
+    inline std::vector<Result>& results() {
+        static std::vector<Result> reported;
+        return reported;
+    }
+
+    inline void report(const std::string& name, double value, const std::string& unit = "ns/op") {
+        std::cout << name << ": " << value << " " << unit << std::endl;
+        results().push_back((Result) { .name = name, .value = value, .unit = unit, .threads = 0 });
+    }
+
+    // For results measured on a thread pool. The thread count is kept out of the name so that runs on machines with
+    // different core counts still compare, and is saved as its own field instead.
+    inline void report_threaded(const std::string& name, double ns_per_op, std::size_t threads) {
+        std::cout << name << " (" << threads << " threads): " << ns_per_op << " ns/op" << std::endl;
+        results().push_back((Result) { .name = name, .value = ns_per_op, .unit = "ns/op", .threads = threads });
+    }
+
+    // Set by checks which failed, so the run exits with an error once every suite is done
+    inline bool& failed() {
+        static bool any_failed = false;
+        return any_failed;
+    }
+
+    inline void check(bool condition, const std::string& message) {
+        if(!condition) {
+            std::cerr << "Check failed: " << message << std::endl;
+            failed() = true;
+        }
+    }
+}
+
+// Component types shared by the suites. Types used by a single suite live in an anonymous namespace in that suite's
+// file, and must still have a name no other suite uses: the ECS identifies component types by their spelling, so two
+// types with the same name would hash alike.
+typedef struct Position {
+    float x;
+    float y;
+} Position;
+
+typedef struct Velocity {
+    float x;
+    float y;
+} Velocity;
+
+// Benchmark suites, one per source file
+void run_component_array_benchmarks();
+void run_world_benchmarks();
+void run_scheduler_benchmarks();
+void run_command_buffer_benchmarks();
+void run_pack_benchmarks();
+void run_signature_benchmarks();
+void run_change_benchmarks();
+void run_rollout_benchmarks();
+void run_allocation_benchmarks();
+void run_snapshot_benchmarks();
+void run_delta_benchmarks();
+void run_spatial_benchmarks();
+void run_soa_benchmarks();
+void run_kernel_benchmarks();
+void run_scaling_benchmarks();
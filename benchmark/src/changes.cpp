@@ -0,0 +1,66 @@
+#include "bench.hpp"
+#include "ecs.hpp"
+
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+void run_change_benchmarks() {
+    const ecs::Entity ENTITY_COUNT = 1000000;
+    const ecs::Entity CHANGED_PER_FRAME = ENTITY_COUNT / 100;
+    const int FRAMES = 5;
+
+    ecs::ECS ecs(ENTITY_COUNT);
+    ecs.register_component<Position>();
+
+    std::vector<ecs::Entity> entities;
+    for(ecs::Entity i = 0; i < ENTITY_COUNT; i++) {
+        ecs::Entity e = ecs.create_entity();
+        ecs.add_component<Position>(e, (Position) { .x = 0.0f, .y = 0.0f });
+        entities.push_back(e);
+    }
+
+    // Moves 1% of the entities each frame, then files the positions into a hashed grid the way a spatial index rebuild
+    // would, either all of them or only the ones which changed since the last frame
+    std::mt19937 rng(13);
+    auto move_some = [&]() {
+        for(ecs::Entity i = 0; i < CHANGED_PER_FRAME; i++) {
+            ecs.get_component<Position>(entities[rng() % ENTITY_COUNT]).x += 1.0f;
+        }
+    };
+
+    std::unordered_map<ecs::Entity, std::int64_t> cells;
+    auto file_position = [&cells](ecs::Entity e, const Position& position) {
+        cells[e] = ((std::int64_t)(position.x / 16.0f) << 32) | (std::int64_t)(position.y / 16.0f);
+    };
+
+    ecs::View positions = ecs.view<const Position>();
+    positions.each(file_position);
+
+    double full_ns = 0;
+    for(int frame = 0; frame < FRAMES; frame++) {
+        move_some();
+        full_ns += bench::time_ns([&]() {
+            positions.each(file_position);
+        });
+    }
+
+    ecs::Tick last_run = ecs.advance_tick();
+    double changed_ns = 0;
+    std::size_t changed_visited = 0;
+    for(int frame = 0; frame < FRAMES; frame++) {
+        move_some();
+        changed_ns += bench::time_ns([&]() {
+            positions.changed<Position>(last_run).each([&](ecs::Entity e, const Position& position) {
+                file_position(e, position);
+                changed_visited++;
+            });
+            last_run = ecs.advance_tick();
+        });
+    }
+    bench::do_not_optimize(cells.size());
+
+    bench::report("1M world, 1% moved per frame, reindex all positions, per frame", full_ns / FRAMES);
+    bench::report("1M world, 1% moved per frame, reindex changed positions, per frame", changed_ns / FRAMES);
+    bench::report("1M world, 1% moved per frame, changed positions visited per frame", (double)changed_visited / FRAMES);
+}
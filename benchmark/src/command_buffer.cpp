@@ -0,0 +1,54 @@
+#include "bench.hpp"
+#include "ecs.hpp"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+static void fill_world(ecs::ECS& ecs, std::vector<ecs::Entity>& entities, ecs::Entity entity_count) {
+    ecs.register_component<Position>();
+    ecs.register_component<Velocity>();
+    for(ecs::Entity i = 0; i < entity_count; i++) {
+        ecs::Entity e = ecs.create_entity();
+        ecs.add_component<Position>(e, (Position) { .x = (float)i, .y = 0.0f });
+        ecs.add_component<Velocity>(e, (Velocity) { .x = 1.0f, .y = 0.0f });
+        entities.push_back(e);
+    }
+
+    // Remove entities in a random order, as a gameplay system would
+    std::shuffle(entities.begin(), entities.end(), std::mt19937(7));
+    entities.resize(entity_count / 2);
+}
+
+void run_command_buffer_benchmarks() {
+    const ecs::Entity ENTITY_COUNT = 1000000;
+
+    std::vector<ecs::Entity> immediate_entities;
+    ecs::ECS immediate_ecs(ENTITY_COUNT);
+    fill_world(immediate_ecs, immediate_entities, ENTITY_COUNT);
+    double immediate_ns = bench::time_ns([&]() {
+        for(ecs::Entity e : immediate_entities) {
+            immediate_ecs.remove_component<Velocity>(e);
+        }
+        for(ecs::Entity e : immediate_entities) {
+            immediate_ecs.remove_entity(e);
+        }
+    });
+
+    std::vector<ecs::Entity> buffered_entities;
+    ecs::ECS buffered_ecs(ENTITY_COUNT);
+    fill_world(buffered_ecs, buffered_entities, ENTITY_COUNT);
+    ecs::CommandBuffer commands(buffered_ecs);
+    double buffered_ns = bench::time_ns([&]() {
+        for(ecs::Entity e : buffered_entities) {
+            commands.remove_component<Velocity>(e);
+        }
+        for(ecs::Entity e : buffered_entities) {
+            commands.remove_entity(e);
+        }
+        commands.flush();
+    });
+
+    bench::report("immediate remove_component + remove_entity", immediate_ns / immediate_entities.size());
+    bench::report("command buffer remove_component + remove_entity", buffered_ns / buffered_entities.size());
+}
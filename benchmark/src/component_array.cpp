@@ -0,0 +1,94 @@
+#include "bench.hpp"
+#include "ecs.hpp"
+
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+const std::uint32_t ENTITY_COUNT = 4096;
+
+// The hash map based component array that ComponentArray replaced, kept here as the baseline to compare against
+template<typename T>
+class MapComponentArray {
+    public:
+        void insert_component(ecs::Entity entity, T component) {
+            size_t new_index = size;
+            entity_to_index_map[entity] = new_index;
+            index_to_entity_map[new_index] = entity;
+            values[new_index] = component;
+            size++;
+        }
+
+        void remove_component(ecs::Entity entity) {
+            size_t index_of_removed_entity = entity_to_index_map[entity];
+            size_t index_of_last_component = size - 1;
+            values[index_of_removed_entity] = values[index_of_last_component];
+
+            ecs::Entity entity_of_last_component = index_to_entity_map[index_of_last_component];
+            entity_to_index_map[entity_of_last_component] = index_of_removed_entity;
+            index_to_entity_map[index_of_removed_entity] = entity_of_last_component;
+
+            entity_to_index_map.erase(entity);
+            index_to_entity_map.erase(index_of_last_component);
+
+            size--;
+        }
+
+        T& get_component(ecs::Entity entity) {
+            return values[entity_to_index_map[entity]];
+        }
+    private:
+        std::array<T, ENTITY_COUNT> values;
+        std::unordered_map<ecs::Entity, size_t> entity_to_index_map;
+        std::unordered_map<size_t, ecs::Entity> index_to_entity_map;
+        std::size_t size = 0;
+};
+
+template<typename Array>
+void benchmark_array(const std::string& name, const std::vector<ecs::Entity>& entities) {
+    const int ROUNDS = 200;
+    double insert_ns = 0;
+    double get_ns = 0;
+    double remove_ns = 0;
+
+    for(int round = 0; round < ROUNDS; round++) {
+        auto array = std::make_unique<Array>();
+
+        insert_ns += bench::time_ns([&]() {
+            for(ecs::Entity e : entities) {
+                array->insert_component(e, (Position) { .x = (float)e, .y = 0.0f });
+            }
+        });
+
+        get_ns += bench::time_ns([&]() {
+            float sum = 0.0f;
+            for(ecs::Entity e : entities) {
+                sum += array->get_component(e).x;
+            }
+            bench::do_not_optimize(sum);
+        });
+
+        remove_ns += bench::time_ns([&]() {
+            for(ecs::Entity e : entities) {
+                array->remove_component(e);
+            }
+        });
+    }
+
+    double operations = (double)ROUNDS * entities.size();
+    bench::report(name + " insert_component", insert_ns / operations);
+    bench::report(name + " get_component", get_ns / operations);
+    bench::report(name + " remove_component", remove_ns / operations);
+}
+
+void run_component_array_benchmarks() {
+    // Touch entities in a random order so neither storage benefits from sequential access
+    std::vector<ecs::Entity> entities(ENTITY_COUNT);
+    std::iota(entities.begin(), entities.end(), 0);
+    std::shuffle(entities.begin(), entities.end(), std::mt19937(42));
+
+    benchmark_array<MapComponentArray<Position>>("unordered_map", entities);
+    benchmark_array<ecs::ComponentArray<Position>>("sparse_set", entities);
+}
@@ -0,0 +1,85 @@
+#include "bench.hpp"
+#include "ecs.hpp"
+
+#include <random>
+#include <vector>
+
+namespace {
+    typedef struct Health {
+        int value;
+    } Health;
+}
+
+static void register_components(ecs::ECS& ecs) {
+    ecs.register_component<Position>();
+    ecs.register_component<Health>();
+}
+
+// Each tick one percent of the world churns: half of that are moved entities, a quarter are destroyed and a quarter
+// are spawned
+void run_delta_benchmarks() {
+    const int ENTITY_COUNT = 100000;
+    const int CHURN = ENTITY_COUNT / 100;
+    const int TICKS = 50;
+
+    ecs::ECS ecs(ENTITY_COUNT);
+    register_components(ecs);
+    std::vector<ecs::Entity> entities = ecs.create_entities(ENTITY_COUNT);
+    for(int i = 0; i < ENTITY_COUNT; i++) {
+        ecs.add_component<Position>(entities[i], (Position) { .x = (float)i, .y = 0.0f });
+        ecs.add_component<Health>(entities[i], (Health) { .value = 100 });
+    }
+
+    // The replica starts from the same baseline and follows along by applying deltas
+    std::vector<std::byte> baseline;
+    ecs.save_snapshot(baseline);
+    ecs::ECS replica(ENTITY_COUNT);
+    register_components(replica);
+    bench::check(replica.load_snapshot(baseline), "Loading the delta baseline failed.");
+
+    std::mt19937 random(42);
+    std::vector<std::byte> delta;
+    std::vector<std::byte> snapshot;
+    double save_delta_ns = 0;
+    double apply_delta_ns = 0;
+    double save_snapshot_ns = 0;
+    bool applied = true;
+    std::size_t delta_bytes = 0;
+    std::size_t snapshot_bytes = 0;
+
+    for(int tick = 0; tick < TICKS; tick++) {
+        ecs.advance_tick();
+        for(int i = 0; i < CHURN / 2; i++) {
+            ecs.get_component<Position>(entities[random() % entities.size()]).x += 1.0f;
+        }
+        for(int i = 0; i < CHURN / 4; i++) {
+            std::size_t victim = random() % entities.size();
+            ecs.remove_entity(entities[victim]);
+
+            entities[victim] = ecs.create_entity();
+            ecs.add_component<Position>(entities[victim], (Position) { .x = 0.0f, .y = 0.0f });
+            ecs.add_component<Health>(entities[victim], (Health) { .value = 100 });
+        }
+
+        save_delta_ns += bench::time_ns([&]() {
+            ecs.save_delta(ecs::SnapshotView(baseline), delta);
+        });
+        apply_delta_ns += bench::time_ns([&]() {
+            applied = replica.apply_delta(delta) && applied;
+        });
+        save_snapshot_ns += bench::time_ns([&]() {
+            ecs.save_snapshot(snapshot);
+        });
+        delta_bytes += delta.size();
+        snapshot_bytes += snapshot.size();
+
+        std::swap(baseline, snapshot);
+    }
+
+    bench::check(applied, "Applying a delta failed.");
+
+    bench::report("100k world 1% churn save_delta", save_delta_ns / TICKS);
+    bench::report("100k world 1% churn apply_delta", apply_delta_ns / TICKS);
+    bench::report("100k world 1% churn save_snapshot", save_snapshot_ns / TICKS);
+    std::cout << "100k world 1% churn delta size: " << delta_bytes / TICKS << " bytes, snapshot size: " << snapshot_bytes / TICKS << " bytes" << std::endl;
+}
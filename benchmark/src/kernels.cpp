@@ -0,0 +1,75 @@
+#include "bench.hpp"
+#include "ecs.hpp"
+
+#include <algorithm>
+#include <vector>
+
+static const Position MINIMUM = (Position) { .x = 0.0f, .y = 0.0f };
+static const Position MAXIMUM = (Position) { .x = 1920.0f, .y = 1080.0f };
+
+static void move(Position& position, const Velocity& velocity) {
+    position.x = std::clamp(position.x + velocity.x, MINIMUM.x, MAXIMUM.x);
+    position.y = std::clamp(position.y + velocity.y, MINIMUM.y, MAXIMUM.y);
+}
+
+// Every entity moves and is kept on screen, first one entity at a time and then a chunk at a time
+void run_kernel_benchmarks() {
+    const int ENTITY_COUNT = 1000000;
+    const int ROUNDS = 10;
+
+    ecs::ECS ecs(ENTITY_COUNT);
+    ecs.register_component<Position>();
+    ecs.register_component<Velocity>();
+    std::vector<ecs::Entity> entities = ecs.create_entities(ENTITY_COUNT);
+    for(int i = 0; i < ENTITY_COUNT; i++) {
+        ecs.add_component<Position>(entities[i], (Position) { .x = (float)(i % 1920), .y = (float)(i % 1080) });
+        ecs.add_component<Velocity>(entities[i], (Velocity) { .x = (float)(i % 7) - 3.0f, .y = (float)(i % 5) - 2.0f });
+    }
+
+    double lookup_ns = bench::time_ns([&]() {
+        for(int round = 0; round < ROUNDS; round++) {
+            for(ecs::Entity e : ecs.view<Position, const Velocity>()) {
+                move(ecs.get_component<Position>(e), ecs.get_component<const Velocity>(e));
+            }
+        }
+    });
+
+    double each_ns = bench::time_ns([&]() {
+        for(int round = 0; round < ROUNDS; round++) {
+            ecs.view<Position, const Velocity>().each(move);
+        }
+    });
+
+    ecs::View packed = ecs.pack<Position, const Velocity>();
+    double packed_each_ns = bench::time_ns([&]() {
+        for(int round = 0; round < ROUNDS; round++) {
+            packed.each(move);
+        }
+    });
+
+    double chunk_ns = bench::time_ns([&]() {
+        for(int round = 0; round < ROUNDS; round++) {
+            packed.each_chunk([](std::span<Position> positions, std::span<const Velocity> velocities) {
+                for(std::size_t i = 0; i < positions.size(); i++) {
+                    move(positions[i], velocities[i]);
+                }
+            });
+        }
+    });
+
+    double kernel_ns = bench::time_ns([&]() {
+        for(int round = 0; round < ROUNDS; round++) {
+            packed.each_chunk([](std::span<Position> positions, std::span<const Velocity> velocities) {
+                ecs::integrate_vec2(positions, velocities);
+                ecs::clamp_vec2(positions, MINIMUM, MAXIMUM);
+            });
+        }
+    });
+    bench::do_not_optimize(ecs.get_component<const Position>(entities[0]));
+
+    bench::report("1M move and clamp, get_component loop per entity", lookup_ns / (ROUNDS * ENTITY_COUNT));
+    bench::report("1M move and clamp, each per entity", each_ns / (ROUNDS * ENTITY_COUNT));
+    bench::report("1M move and clamp, packed each per entity", packed_each_ns / (ROUNDS * ENTITY_COUNT));
+    bench::report("1M move and clamp, each_chunk scalar loop per entity", chunk_ns / (ROUNDS * ENTITY_COUNT));
+    bench::report("1M move and clamp, each_chunk integrate_vec2 and clamp_vec2 per entity", kernel_ns / (ROUNDS * ENTITY_COUNT));
+}
@@ -0,0 +1,200 @@
+#include "bench.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+
+typedef struct Suite {
+    const char* name;
+    void (*run)();
+} Suite;
+
+static const Suite SUITES[] = {
+    { "component_array", run_component_array_benchmarks },
+    { "world", run_world_benchmarks },
+    { "scheduler", run_scheduler_benchmarks },
+    { "command_buffer", run_command_buffer_benchmarks },
+    { "pack", run_pack_benchmarks },
+    { "signature", run_signature_benchmarks },
+    { "change", run_change_benchmarks },
+    { "rollout", run_rollout_benchmarks },
+    { "allocation", run_allocation_benchmarks },
+    { "snapshot", run_snapshot_benchmarks },
+    { "delta", run_delta_benchmarks },
+    { "spatial", run_spatial_benchmarks },
+    { "soa", run_soa_benchmarks },
+    { "kernel", run_kernel_benchmarks },
+    { "scaling", run_scaling_benchmarks }
+};
+
+static std::string escape_json(const std::string& text) {
+    std::string escaped;
+    for(char c : text) {
+        if(c == '"' || c == '\\') {
+            escaped += '\\';
+        }
+        escaped += c;
+    }
+    return escaped;
+}
+
+// Writes one result per line, so that two runs can also be compared with a plain diff
+static bool write_json(const std::string& path) {
+    std::ofstream file(path);
+    if(!file) {
+        return false;
+    }
+
+    file << "{\n";
+    file << "    \"compiler\": \"" << escape_json(__VERSION__) << "\",\n";
+    file << "    \"results\": [\n";
+    const std::vector<bench::Result>& results = bench::results();
+    for(std::size_t i = 0; i < results.size(); i++) {
+        file << "        { \"name\": \"" << escape_json(results[i].name) << "\", \"value\": " << results[i].value << ", \"unit\": \"" << escape_json(results[i].unit) << "\"";
+        if(results[i].threads > 0) {
+            file << ", \"threads\": " << results[i].threads;
+        }
+        file << " }";
+        file << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    file << "    ]\n";
+    file << "}\n";
+
+    return (bool)file;
+}
+
+// Reads back the results of a file written by write_json. This is not a general JSON parser, it only understands the
+// one result per line layout written above.
+static bool read_json(const std::string& path, std::map<std::string, bench::Result>& results) {
+    std::ifstream file(path);
+    if(!file) {
+        return false;
+    }
+
+    const std::string NAME_KEY = "\"name\": \"";
+    const std::string VALUE_KEY = "\"value\": ";
+    const std::string THREADS_KEY = "\"threads\": ";
+    std::string line;
+    while(std::getline(file, line)) {
+        std::size_t name_start = line.find(NAME_KEY);
+        std::size_t value_start = line.find(VALUE_KEY);
+        if(name_start == std::string::npos || value_start == std::string::npos) {
+            continue;
+        }
+
+        std::string name;
+        for(std::size_t i = name_start + NAME_KEY.size(); i < line.size() && line[i] != '"'; i++) {
+            if(line[i] == '\\' && i + 1 < line.size()) {
+                i++;
+            }
+            name += line[i];
+        }
+        bench::Result& result = results[name];
+        result.name = name;
+        result.value = std::strtod(line.c_str() + value_start + VALUE_KEY.size(), nullptr);
+
+        std::size_t threads_start = line.find(THREADS_KEY);
+        result.threads = threads_start == std::string::npos ? 0 : std::strtoull(line.c_str() + threads_start + THREADS_KEY.size(), nullptr, 10);
+    }
+
+    return true;
+}
+
+// Prints how much every result has changed since the baseline run. Positive percentages are slower than the baseline,
+// or more allocations. Results measured with a different number of threads are flagged.
+static void compare(const std::map<std::string, bench::Result>& baseline) {
+    std::cout << std::endl << "Compared to the baseline:" << std::endl;
+    for(const bench::Result& result : bench::results()) {
+        auto found = baseline.find(result.name);
+        if(found == baseline.end()) {
+            std::cout << result.name << ": new" << std::endl;
+            continue;
+        }
+
+        std::string threads;
+        if(found->second.threads != result.threads) {
+            threads = " [" + std::to_string(found->second.threads) + " -> " + std::to_string(result.threads) + " threads]";
+        }
+        if(found->second.value <= 0.0) {
+            std::cout << result.name << ": " << found->second.value << " -> " << result.value << " " << result.unit << threads << std::endl;
+            continue;
+        }
+
+        char change[32];
+        std::snprintf(change, sizeof(change), "%+.1f%%", (result.value / found->second.value - 1.0) * 100.0);
+        std::cout << result.name << ": " << found->second.value << " -> " << result.value << " " << result.unit << " (" << change << ")" << threads << std::endl;
+    }
+}
+
+static void print_usage(const char* program) {
+    std::cerr << "Usage: " << program << " [--suite <name>]... [--json <output>] [--compare <baseline>]" << std::endl;
+    std::cerr << "Suites:";
+    for(const Suite& suite : SUITES) {
+        std::cerr << " " << suite.name;
+    }
+    std::cerr << std::endl;
+}
+
+int main(int argc, char** argv) {
+    std::vector<const Suite*> selected;
+    std::string json_path;
+    std::string baseline_path;
+
+    for(int i = 1; i < argc; i++) {
+        if(i + 1 >= argc) {
+            print_usage(argv[0]);
+            return 1;
+        }
+
+        if(std::strcmp(argv[i], "--suite") == 0) {
+            const char* name = argv[++i];
+            const Suite* found = nullptr;
+            for(const Suite& suite : SUITES) {
+                if(std::strcmp(suite.name, name) == 0) {
+                    found = &suite;
+                }
+            }
+            if(found == nullptr) {
+                std::cerr << "Unknown suite " << name << "." << std::endl;
+                print_usage(argv[0]);
+                return 1;
+            }
+            selected.push_back(found);
+        } else if(std::strcmp(argv[i], "--json") == 0) {
+            json_path = argv[++i];
+        } else if(std::strcmp(argv[i], "--compare") == 0) {
+            baseline_path = argv[++i];
+        } else {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    // Read the baseline before running anything, so a wrong path doesn't cost a whole run
+    std::map<std::string, bench::Result> baseline;
+    if(!baseline_path.empty() && !read_json(baseline_path, baseline)) {
+        std::cerr << "Cannot read baseline " << baseline_path << "." << std::endl;
+        return 1;
+    }
+
+    if(selected.empty()) {
+        for(const Suite& suite : SUITES) {
+            selected.push_back(&suite);
+        }
+    }
+    for(const Suite* suite : selected) {
+        suite->run();
+    }
+
+    if(!json_path.empty() && !write_json(json_path)) {
+        std::cerr << "Cannot write results to " << json_path << "." << std::endl;
+        return 1;
+    }
+    if(!baseline_path.empty()) {
+        compare(baseline);
+    }
+
+    return bench::failed() ? 1 : 0;
+}
@@ -0,0 +1,55 @@
+#include "bench.hpp"
+#include "ecs.hpp"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+void run_pack_benchmarks() {
+    const ecs::Entity ENTITY_COUNT = 1000000;
+    const int FRAMES = 20;
+
+    ecs::ECS ecs(ENTITY_COUNT);
+    ecs.register_component<Position>();
+    ecs.register_component<Velocity>();
+
+    std::vector<ecs::Entity> entities;
+    for(ecs::Entity i = 0; i < ENTITY_COUNT; i++) {
+        ecs::Entity e = ecs.create_entity();
+        ecs.add_component<Position>(e, (Position) { .x = 0.0f, .y = 0.0f });
+        entities.push_back(e);
+    }
+
+    // Velocities are added in a different order than positions, and only to most entities, as happens when
+    // components are added over the course of a game
+    std::shuffle(entities.begin(), entities.end(), std::mt19937(3));
+    for(ecs::Entity i = 0; i < ENTITY_COUNT * 3 / 4; i++) {
+        ecs.add_component<Velocity>(entities[i], (Velocity) { .x = 1.0f, .y = 1.0f });
+    }
+
+    auto integrate = [](Position& position, Velocity& velocity) {
+        position.x += velocity.x;
+        position.y += velocity.y;
+    };
+
+    ecs::View movement_view = ecs.view<Position, Velocity>();
+    double sparse_ns = bench::time_ns([&]() {
+        for(int frame = 0; frame < FRAMES; frame++) {
+            movement_view.each(integrate);
+        }
+    });
+
+    double pack_ns = bench::time_ns([&]() {
+        ecs.pack<Position, Velocity>();
+    });
+    double packed_ns = bench::time_ns([&]() {
+        for(int frame = 0; frame < FRAMES; frame++) {
+            movement_view.each(integrate);
+        }
+    });
+
+    double per_entity = (double)FRAMES * movement_view.size();
+    bench::report("view<Position, Velocity> each, separate arrays, per entity", sparse_ns / per_entity);
+    bench::report("pack<Position, Velocity> one-off", pack_ns);
+    bench::report("view<Position, Velocity> each, packed arrays, per entity", packed_ns / per_entity);
+}
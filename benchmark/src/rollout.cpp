@@ -0,0 +1,48 @@
+#include "bench.hpp"
+#include "ecs.hpp"
+
+#include <utility>
+
+namespace {
+    template<int N>
+    struct Tagged {
+        float value;
+    };
+}
+
+template<int... N>
+void register_tagged(ecs::ECS& ecs, std::integer_sequence<int, N...>) {
+    (ecs.register_component<Tagged<N>>(), ...);
+}
+
+// Simulation rollouts create many small, short-lived worlds with a lot of component types registered, most of which
+// are never used by any one rollout
+void run_rollout_benchmarks() {
+    const int WORLD_COUNT = 2000;
+    const int TYPE_COUNT = 40;
+    const int ENTITY_COUNT = 64;
+
+    double empty_ns = bench::time_ns([&]() {
+        for(int world = 0; world < WORLD_COUNT; world++) {
+            ecs::ECS ecs;
+            register_tagged(ecs, std::make_integer_sequence<int, TYPE_COUNT>());
+            bench::do_not_optimize(ecs);
+        }
+    });
+
+    double small_ns = bench::time_ns([&]() {
+        for(int world = 0; world < WORLD_COUNT; world++) {
+            ecs::ECS ecs;
+            register_tagged(ecs, std::make_integer_sequence<int, TYPE_COUNT>());
+            for(int i = 0; i < ENTITY_COUNT; i++) {
+                ecs::Entity e = ecs.create_entity();
+                ecs.add_component<Tagged<0>>(e, (Tagged<0>) { .value = (float)i });
+                ecs.add_component<Tagged<1>>(e, (Tagged<1>) { .value = (float)i });
+            }
+            bench::do_not_optimize(ecs);
+        }
+    });
+
+    bench::report("world with 40 component types, create and destroy", empty_ns / WORLD_COUNT);
+    bench::report("world with 40 component types and 64 entities, create and destroy", small_ns / WORLD_COUNT);
+}
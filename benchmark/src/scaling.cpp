@@ -0,0 +1,202 @@
+#include "bench.hpp"
+#include "ecs.hpp"
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+    // Only given to some of the entities, to vary how many entities a view matches
+    typedef struct Tag {
+        int value;
+    } Tag;
+}
+
+// Small worlds are measured many times over so that every measurement covers about as many operations
+const std::size_t OPERATIONS_PER_MEASUREMENT = 1000000;
+
+static std::string size_name(std::size_t entity_count) {
+    if(entity_count >= 1000000) {
+        return std::to_string(entity_count / 1000000) + "M";
+    }
+    if(entity_count >= 1000) {
+        return std::to_string(entity_count / 1000) + "k";
+    }
+    return std::to_string(entity_count);
+}
+
+static void register_components(ecs::ECS& ecs) {
+    ecs.register_component<Position>();
+    ecs.register_component<Velocity>();
+    ecs.register_component<Tag>();
+}
+
+static std::vector<ecs::Entity> shuffled(std::vector<ecs::Entity> entities, std::mt19937& random) {
+    std::shuffle(entities.begin(), entities.end(), random);
+    return entities;
+}
+
+// The time each operation takes on its own, on a world which holds the given number of entities. Entities are
+// removed and components are looked up in a random order, so the measurements don't favour the order they were made.
+static void benchmark_operations(std::size_t entity_count, std::mt19937& random) {
+    const std::size_t ROUNDS = std::max<std::size_t>(1, OPERATIONS_PER_MEASUREMENT / entity_count);
+    std::string prefix = size_name(entity_count) + " entities ";
+
+    double create_ns = 0;
+    double add_ns = 0;
+    double get_ns = 0;
+    double remove_component_ns = 0;
+    double remove_entity_ns = 0;
+    for(std::size_t round = 0; round < ROUNDS; round++) {
+        ecs::ECS ecs(entity_count);
+        register_components(ecs);
+        std::vector<ecs::Entity> entities;
+        entities.reserve(entity_count);
+
+        create_ns += bench::time_ns([&]() {
+            for(std::size_t i = 0; i < entity_count; i++) {
+                entities.push_back(ecs.create_entity());
+            }
+        });
+
+        add_ns += bench::time_ns([&]() {
+            for(std::size_t i = 0; i < entity_count; i++) {
+                ecs.add_component<Position>(entities[i], (Position) { .x = (float)i, .y = 0.0f });
+            }
+        });
+
+        std::vector<ecs::Entity> random_order = shuffled(entities, random);
+        float sum = 0.0f;
+        get_ns += bench::time_ns([&]() {
+            for(ecs::Entity e : random_order) {
+                sum += ecs.get_component<const Position>(e).x;
+            }
+        });
+        bench::do_not_optimize(sum);
+
+        remove_component_ns += bench::time_ns([&]() {
+            for(ecs::Entity e : random_order) {
+                ecs.remove_component<Position>(e);
+            }
+        });
+
+        random_order = shuffled(entities, random);
+        remove_entity_ns += bench::time_ns([&]() {
+            for(ecs::Entity e : random_order) {
+                ecs.remove_entity(e);
+            }
+        });
+    }
+
+    double operation_count = (double)(ROUNDS * entity_count);
+    bench::report(prefix + "create_entity", create_ns / operation_count);
+    bench::report(prefix + "add_component", add_ns / operation_count);
+    bench::report(prefix + "get_component (random order)", get_ns / operation_count);
+    bench::report(prefix + "remove_component (random order)", remove_component_ns / operation_count);
+    bench::report(prefix + "remove_entity (random order)", remove_entity_ns / operation_count);
+}
+
+// Building a view's group the first time it is asked for, and iterating it afterwards, when only a share of the
+// entities have every component the view asks for
+static void benchmark_view_densities(std::size_t entity_count, std::mt19937& random) {
+    const std::size_t ROUNDS = std::max<std::size_t>(1, OPERATIONS_PER_MEASUREMENT / entity_count);
+    const int ITERATIONS = 10;
+    std::string prefix = size_name(entity_count) + " entities ";
+
+    for(int percent : { 100, 50, 10, 1 }) {
+        double build_ns = 0;
+        double each_ns = 0;
+        std::size_t matched = 0;
+        for(std::size_t round = 0; round < ROUNDS; round++) {
+            ecs::ECS ecs(entity_count);
+            register_components(ecs);
+            std::vector<ecs::Entity> entities = ecs.create_entities(entity_count);
+            for(std::size_t i = 0; i < entity_count; i++) {
+                ecs.add_component<Position>(entities[i], (Position) { .x = (float)i, .y = 0.0f });
+                ecs.add_component<Velocity>(entities[i], (Velocity) { .x = 1.0f, .y = 1.0f });
+                if(random() % 100 < (unsigned int)percent) {
+                    ecs.add_component<Tag>(entities[i], (Tag) { .value = (int)i });
+                }
+            }
+
+            build_ns += bench::time_ns([&]() {
+                bench::do_not_optimize(ecs.view<Position, const Velocity, const Tag>().size());
+            });
+
+            ecs::View view = ecs.view<Position, const Velocity, const Tag>();
+            matched += view.size() * ITERATIONS;
+            each_ns += bench::time_ns([&]() {
+                for(int iteration = 0; iteration < ITERATIONS; iteration++) {
+                    view.each([](Position& position, const Velocity& velocity, const Tag&) {
+                        position.x += velocity.x;
+                        position.y += velocity.y;
+                    });
+                }
+            });
+        }
+
+        std::string density = std::to_string(percent) + "% match";
+        bench::report(prefix + "view build per entity, " + density, build_ns / (double)(ROUNDS * entity_count));
+        bench::report(prefix + "view each per matched entity, " + density, each_ns / (double)std::max<std::size_t>(matched, 1));
+    }
+}
+
+// Iterating a view after the world has been built up in different ways. In order, every entity gets its components
+// in creation order. Interleaved frees every other entity and creates new ones into the holes, so the dense arrays no
+// longer follow the slots. Shuffled adds the components in a random entity order, so a view walking one array looks
+// up the other one all over the place.
+static void benchmark_fragmentation(std::size_t entity_count, std::mt19937& random) {
+    const std::size_t ROUNDS = std::max<std::size_t>(1, OPERATIONS_PER_MEASUREMENT / entity_count);
+    const int ITERATIONS = 10;
+    std::string prefix = size_name(entity_count) + " entities ";
+
+    for(std::string pattern : { "in order", "interleaved", "shuffled" }) {
+        double each_ns = 0;
+        std::size_t visited = 0;
+        for(std::size_t round = 0; round < ROUNDS; round++) {
+            ecs::ECS ecs(entity_count);
+            register_components(ecs);
+            std::vector<ecs::Entity> entities = ecs.create_entities(entity_count);
+            if(pattern == "interleaved") {
+                for(std::size_t i = 0; i < entity_count; i += 2) {
+                    ecs.remove_entity(entities[i]);
+                }
+                for(std::size_t i = 0; i < entity_count; i += 2) {
+                    entities[i] = ecs.create_entity();
+                }
+            }
+
+            std::vector<ecs::Entity> position_order = pattern == "shuffled" ? shuffled(entities, random) : entities;
+            std::vector<ecs::Entity> velocity_order = pattern == "shuffled" ? shuffled(entities, random) : entities;
+            for(ecs::Entity e : position_order) {
+                ecs.add_component<Position>(e, (Position) { .x = 0.0f, .y = 0.0f });
+            }
+            for(ecs::Entity e : velocity_order) {
+                ecs.add_component<Velocity>(e, (Velocity) { .x = 1.0f, .y = 1.0f });
+            }
+
+            ecs::View view = ecs.view<Position, const Velocity>();
+            visited += view.size() * ITERATIONS;
+            each_ns += bench::time_ns([&]() {
+                for(int iteration = 0; iteration < ITERATIONS; iteration++) {
+                    view.each([](Position& position, const Velocity& velocity) {
+                        position.x += velocity.x;
+                        position.y += velocity.y;
+                    });
+                }
+            });
+        }
+
+        bench::report(prefix + "view each per entity, " + pattern, each_ns / (double)visited);
+    }
+}
+
+void run_scaling_benchmarks() {
+    std::mt19937 random(42);
+    for(std::size_t entity_count : { 1000, 64000, 1000000 }) {
+        benchmark_operations(entity_count, random);
+        benchmark_view_densities(entity_count, random);
+        benchmark_fragmentation(entity_count, random);
+    }
+}
@@ -0,0 +1,91 @@
+#include "bench.hpp"
+#include "ecs.hpp"
+
+#include <cmath>
+
+namespace {
+    typedef struct Stamina {
+        float value;
+    } Stamina;
+
+    typedef struct Heat {
+        float value;
+    } Heat;
+}
+
+void run_scheduler_benchmarks() {
+    const ecs::Entity ENTITY_COUNT = 200000;
+    const int FRAMES = 20;
+
+    ecs::ECS ecs(ENTITY_COUNT);
+    ecs.register_component<Position>();
+    ecs.register_component<Velocity>();
+    ecs.register_component<Stamina>();
+    ecs.register_component<Heat>();
+    for(ecs::Entity i = 0; i < ENTITY_COUNT; i++) {
+        ecs::Entity e = ecs.create_entity();
+        ecs.add_component<Position>(e, (Position) { .x = 0.0f, .y = 0.0f });
+        ecs.add_component<Velocity>(e, (Velocity) { .x = 1.0f, .y = 1.0f });
+        ecs.add_component<Stamina>(e, (Stamina) { .value = 100.0f });
+        ecs.add_component<Heat>(e, (Heat) { .value = 0.0f });
+    }
+
+    // Three systems touching disjoint components, which the scheduler can run side by side
+    auto movement = [](ecs::ECS& ecs) {
+        ecs.view<Position, const Velocity>().each([](Position& position, const Velocity& velocity) {
+            position.x += velocity.x;
+            position.y += velocity.y;
+        });
+    };
+    auto regeneration = [](ecs::ECS& ecs) {
+        ecs.view<Stamina>().each([](Stamina& stamina) {
+            stamina.value = std::sqrt(stamina.value * stamina.value + 1.0f);
+        });
+    };
+    auto cooling = [](ecs::ECS& ecs) {
+        ecs.view<Heat>().each([](Heat& heat) {
+            heat.value = std::exp(-heat.value);
+        });
+    };
+
+    double sequential_ns = bench::time_ns([&]() {
+        for(int frame = 0; frame < FRAMES; frame++) {
+            movement(ecs);
+            regeneration(ecs);
+            cooling(ecs);
+        }
+    });
+
+    ecs::ThreadPool thread_pool;
+    ecs::Scheduler scheduler(ecs, thread_pool);
+    scheduler.add_system<ecs::Reads<Velocity>, ecs::Writes<Position>>(movement);
+    scheduler.add_system<ecs::Writes<Stamina>>(regeneration);
+    scheduler.add_system<ecs::Writes<Heat>>(cooling);
+
+    double scheduled_ns = bench::time_ns([&]() {
+        for(int frame = 0; frame < FRAMES; frame++) {
+            scheduler.run();
+        }
+    });
+
+    // A single system split across the pool
+    auto integrate = [](Position& position, Velocity& velocity) {
+        position.x += velocity.x;
+        position.y += velocity.y;
+    };
+    double each_ns = bench::time_ns([&]() {
+        for(int frame = 0; frame < FRAMES; frame++) {
+            ecs.view<Position, Velocity>().each(integrate);
+        }
+    });
+    double par_each_ns = bench::time_ns([&]() {
+        for(int frame = 0; frame < FRAMES; frame++) {
+            ecs.view<Position, Velocity>().par_each(thread_pool, integrate);
+        }
+    });
+
+    bench::report("3 systems sequential frame", sequential_ns / FRAMES);
+    bench::report_threaded("3 systems scheduled frame", scheduled_ns / FRAMES, thread_pool.size());
+    bench::report("movement each per entity", each_ns / ((double)FRAMES * ENTITY_COUNT));
+    bench::report_threaded("movement par_each per entity", par_each_ns / ((double)FRAMES * ENTITY_COUNT), thread_pool.size());
+}
@@ -0,0 +1,48 @@
+#include "bench.hpp"
+#include "ecs.hpp"
+
+#include <random>
+#include <vector>
+
+void run_signature_benchmarks() {
+    const std::size_t SIGNATURE_COUNT = 1000000;
+    const int ROUNDS = 20;
+
+    // Each entity has a handful of the 256 component types, with low numbered types more common
+    std::mt19937 rng(11);
+    std::vector<ecs::Signature> signatures(SIGNATURE_COUNT);
+    for(ecs::Signature& signature : signatures) {
+        for(int i = 0; i < 8; i++) {
+            signature.set((ecs::ComponentType)(rng() % (1 + rng() % ecs::MAX_COMPONENTS)));
+        }
+    }
+
+    ecs::Signature required;
+    required.set(1);
+    required.set(5);
+
+    std::size_t naive_matches = 0;
+    double naive_ns = bench::time_ns([&]() {
+        for(int round = 0; round < ROUNDS; round++) {
+            for(const ecs::Signature& signature : signatures) {
+                if((signature & required) == required) {
+                    naive_matches++;
+                }
+            }
+        }
+    });
+
+    std::size_t matches = 0;
+    double matched_ns = bench::time_ns([&]() {
+        for(int round = 0; round < ROUNDS; round++) {
+            ecs::match_signatures(signatures.data(), signatures.size(), required, [&matches](std::size_t) {
+                matches++;
+            });
+        }
+    });
+    bench::do_not_optimize(naive_matches);
+    bench::do_not_optimize(matches);
+
+    bench::report("signature match, bitwise and compare, per entity", naive_ns / ((double)ROUNDS * SIGNATURE_COUNT));
+    bench::report("signature match, match_signatures, per entity", matched_ns / ((double)ROUNDS * SIGNATURE_COUNT));
+}
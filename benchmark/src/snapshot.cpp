@@ -0,0 +1,110 @@
+#include "bench.hpp"
+#include "ecs.hpp"
+
+#include <cstdio>
+#include <filesystem>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <vector>
+
+static void register_components(ecs::ECS& ecs) {
+    ecs.register_component<Position>();
+    ecs.register_component<Velocity>();
+}
+
+void run_snapshot_benchmarks() {
+    const ecs::Entity ENTITY_COUNT = 1000000;
+
+    ecs::ECS ecs(ENTITY_COUNT);
+    register_components(ecs);
+    std::vector<ecs::Entity> entities = ecs.create_entities(ENTITY_COUNT);
+    for(ecs::Entity i = 0; i < ENTITY_COUNT; i++) {
+        ecs.add_component<Position>(entities[i], (Position) { .x = (float)i, .y = 0.0f });
+        ecs.add_component<Velocity>(entities[i], (Velocity) { .x = 1.0f, .y = 0.0f });
+    }
+
+    // Rollback saves into the same buffer every frame, so only the first save pays for growing it
+    std::vector<std::byte> snapshot;
+    double first_save_ns = bench::time_ns([&]() {
+        ecs.save_snapshot(snapshot);
+    });
+    double save_ns = bench::time_ns([&]() {
+        ecs.save_snapshot(snapshot);
+    });
+
+    // Restoring by replaying every entity through the ECS, for comparison
+    double replay_ns = bench::time_ns([&]() {
+        ecs::ECS replayed(ENTITY_COUNT);
+        register_components(replayed);
+        std::vector<ecs::Entity> replayed_entities = replayed.create_entities(ENTITY_COUNT);
+        for(ecs::Entity i = 0; i < ENTITY_COUNT; i++) {
+            replayed.add_component<Position>(replayed_entities[i], ecs.get_component<const Position>(entities[i]));
+            replayed.add_component<Velocity>(replayed_entities[i], ecs.get_component<const Velocity>(entities[i]));
+        }
+        bench::do_not_optimize(replayed);
+    });
+
+    ecs::ECS loaded(ENTITY_COUNT);
+    register_components(loaded);
+    bool loaded_ok = true;
+    double first_load_ns = bench::time_ns([&]() {
+        loaded_ok = loaded.load_snapshot(snapshot) && loaded_ok;
+    });
+    double load_ns = bench::time_ns([&]() {
+        loaded_ok = loaded.load_snapshot(snapshot) && loaded_ok;
+    });
+    bench::check(loaded_ok, "Loading the snapshot from memory failed.");
+
+    bench::report("1M entity snapshot save into a new buffer", first_save_ns);
+    bench::report("1M entity snapshot save into a reused buffer", save_ns);
+    bench::report("1M entity restore by add_component replay", replay_ns);
+    bench::report("1M entity snapshot load into a new world", first_load_ns);
+    bench::report("1M entity snapshot load into the same world again", load_ns);
+
+    // Load from a memory mapped file, the way a restarting server would
+    std::string path = (std::filesystem::temp_directory_path() / ("ecs-bench-snapshot-" + std::to_string(getpid()) + ".bin")).string();
+    FILE* file = std::fopen(path.c_str(), "wb");
+    if(file == nullptr) {
+        bench::check(false, "Cannot create " + path + ".");
+        return;
+    }
+    bool written = std::fwrite(snapshot.data(), 1, snapshot.size(), file) == snapshot.size();
+    written = std::fclose(file) == 0 && written;
+
+    int descriptor = written ? open(path.c_str(), O_RDONLY) : -1;
+    void* mapping = descriptor >= 0 ? mmap(nullptr, snapshot.size(), PROT_READ, MAP_PRIVATE, descriptor, 0) : MAP_FAILED;
+    if(mapping == MAP_FAILED) {
+        bench::check(false, "Cannot write and map " + path + ".");
+        if(descriptor >= 0) {
+            close(descriptor);
+        }
+        std::remove(path.c_str());
+        return;
+    }
+    std::span<const std::byte> mapped((const std::byte*)mapping, snapshot.size());
+
+    ecs::ECS mapped_loaded(ENTITY_COUNT);
+    register_components(mapped_loaded);
+    bool mapped_ok = false;
+    double mapped_load_ns = bench::time_ns([&]() {
+        mapped_ok = mapped_loaded.load_snapshot(mapped);
+    });
+    bench::check(mapped_ok, "Loading the snapshot from the mapped file failed.");
+
+    double view_ns = bench::time_ns([&]() {
+        ecs::SnapshotView view(mapped);
+        float sum = 0.0f;
+        for(const Position& position : view.components<Position>()) {
+            sum += position.x;
+        }
+        bench::do_not_optimize(sum);
+    });
+
+    munmap(mapping, snapshot.size());
+    close(descriptor);
+    std::remove(path.c_str());
+
+    bench::report("1M entity snapshot load from mapped file into a new world", mapped_load_ns);
+    bench::report("1M entity snapshot view sum of positions from mapped file", view_ns);
+}
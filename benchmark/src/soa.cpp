@@ -0,0 +1,82 @@
+#include "bench.hpp"
+#include "ecs.hpp"
+
+#include <array>
+#include <vector>
+
+namespace {
+    typedef struct Vec2 {
+        float x;
+        float y;
+    } Vec2;
+
+    // The same component twice, once stored as an array of structs and once split into member arrays. Movement only
+    // reads the first two members, the rest is what a real component carries around for other systems.
+    typedef struct Body {
+        Vec2 position;
+        Vec2 velocity;
+        std::array<float, 12> cold;
+    } Body;
+
+    typedef struct SplitBody {
+        Vec2 position;
+        Vec2 velocity;
+        std::array<float, 12> cold;
+    } SplitBody;
+}
+
+template<>
+struct ecs::SoaLayout<SplitBody> {
+    static constexpr auto members = std::make_tuple(&SplitBody::position, &SplitBody::velocity, &SplitBody::cold);
+};
+
+void run_soa_benchmarks() {
+    const int ENTITY_COUNT = 1000000;
+    const int ROUNDS = 10;
+
+    ecs::ECS ecs(ENTITY_COUNT);
+    ecs.register_component<Body>();
+    ecs.register_component<SplitBody>();
+    std::vector<ecs::Entity> entities = ecs.create_entities(ENTITY_COUNT);
+    for(int i = 0; i < ENTITY_COUNT; i++) {
+        ecs.add_component<Body>(entities[i], (Body) { .position = { (float)i, 0.0f }, .velocity = { 1.0f, 2.0f }, .cold = {} });
+        ecs.add_component<SplitBody>(entities[i], (SplitBody) { .position = { (float)i, 0.0f }, .velocity = { 1.0f, 2.0f }, .cold = {} });
+    }
+
+    double struct_ns = bench::time_ns([&]() {
+        for(int round = 0; round < ROUNDS; round++) {
+            ecs.view<Body>().each([](Body& body) {
+                body.position.x += body.velocity.x;
+                body.position.y += body.velocity.y;
+            });
+        }
+    });
+
+    double proxy_ns = bench::time_ns([&]() {
+        for(int round = 0; round < ROUNDS; round++) {
+            ecs.view<SplitBody>().each([](ecs::SoaReference<SplitBody> body) {
+                Vec2& position = body.get<&SplitBody::position>();
+                const Vec2& velocity = body.get<&SplitBody::velocity>();
+                position.x += velocity.x;
+                position.y += velocity.y;
+            });
+        }
+    });
+
+    ecs::ComponentStorage<SplitBody>& split_storage = ecs.storage<SplitBody>();
+    double column_ns = bench::time_ns([&]() {
+        for(int round = 0; round < ROUNDS; round++) {
+            std::span<Vec2> positions = split_storage.column<&SplitBody::position>();
+            std::span<const Vec2> velocities = std::as_const(split_storage).column<&SplitBody::velocity>();
+            for(std::size_t i = 0; i < positions.size(); i++) {
+                positions[i].x += velocities[i].x;
+                positions[i].y += velocities[i].y;
+            }
+        }
+    });
+    bench::do_not_optimize(split_storage);
+
+    bench::report("1M 64 byte components, move through each on an array of structs per entity", struct_ns / (ROUNDS * ENTITY_COUNT));
+    bench::report("1M 64 byte components, move through each on member arrays per entity", proxy_ns / (ROUNDS * ENTITY_COUNT));
+    bench::report("1M 64 byte components, move over member array columns per entity", column_ns / (ROUNDS * ENTITY_COUNT));
+}
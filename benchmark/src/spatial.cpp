@@ -0,0 +1,98 @@
+#include "bench.hpp"
+#include "ecs.hpp"
+
+#include <random>
+#include <vector>
+
+namespace {
+    typedef struct Collider {
+        float x;
+        float y;
+        float size;
+    } Collider;
+}
+
+static ecs::Bounds body_bounds(const Collider& body) {
+    return (ecs::Bounds) { .min_x = body.x, .min_y = body.y, .max_x = body.x + body.size, .max_y = body.y + body.size };
+}
+
+// Bodies are scattered over a square about as dense as a busy scene, and a tenth of them move every frame
+void run_spatial_benchmarks() {
+    const int BODY_COUNT = 20000;
+    const float WORLD_SIZE = 4000.0f;
+    const int MOVED_PER_FRAME = BODY_COUNT / 10;
+    const int FRAMES = 100;
+
+    ecs::ECS ecs(BODY_COUNT);
+    ecs.register_component<Collider>();
+    ecs::SpatialGrid<Collider> grid(ecs, 32.0f, body_bounds);
+
+    std::mt19937 random(42);
+    std::uniform_real_distribution<float> coordinate(0.0f, WORLD_SIZE);
+    std::uniform_real_distribution<float> step(-4.0f, 4.0f);
+    std::vector<ecs::Entity> bodies = ecs.create_entities(BODY_COUNT);
+    for(ecs::Entity body : bodies) {
+        ecs.add_component<Collider>(body, (Collider) { .x = coordinate(random), .y = coordinate(random), .size = 16.0f });
+    }
+
+    double build_ns = bench::time_ns([&]() {
+        grid.update();
+    });
+    ecs.advance_tick();
+
+    double update_ns = 0;
+    double pairs_ns = 0;
+    double rect_ns = 0;
+    std::size_t pair_count = 0;
+    std::size_t rect_count = 0;
+    std::vector<ecs::Entity> moved(MOVED_PER_FRAME);
+    for(int frame = 0; frame < FRAMES; frame++) {
+        for(ecs::Entity& body : moved) {
+            body = bodies[random() % bodies.size()];
+            Collider& moved_body = ecs.get_component<Collider>(body);
+            moved_body.x += step(random);
+            moved_body.y += step(random);
+        }
+
+        update_ns += bench::time_ns([&]() {
+            grid.update();
+        });
+        ecs.advance_tick();
+
+        pair_count = 0;
+        pairs_ns += bench::time_ns([&]() {
+            grid.query_pairs([&pair_count](ecs::Entity, ecs::Entity) {
+                pair_count++;
+            });
+        });
+
+        // What each moved body would ask to find what it hit
+        rect_ns += bench::time_ns([&]() {
+            for(ecs::Entity body : moved) {
+                grid.query_rect(body_bounds(ecs.get_component<const Collider>(body)), [&rect_count](ecs::Entity) {
+                    rect_count++;
+                });
+            }
+        });
+    }
+
+    // Testing every body against every other body, for comparison with the last frame
+    std::size_t brute_force_count = 0;
+    ecs::ComponentStorage<Collider>& body_storage = ecs.storage<Collider>();
+    double brute_force_ns = bench::time_ns([&]() {
+        for(std::size_t a = 0; a < body_storage.size(); a++) {
+            ecs::Bounds bounds_a = body_bounds(std::as_const(body_storage).value_at(a));
+            for(std::size_t b = a + 1; b < body_storage.size(); b++) {
+                brute_force_count += bounds_a.intersects(body_bounds(std::as_const(body_storage).value_at(b)));
+            }
+        }
+    });
+    bench::do_not_optimize(rect_count);
+
+    bench::report("20k bodies spatial grid build", build_ns);
+    bench::report("20k bodies spatial grid update with 10% moved", update_ns / FRAMES);
+    bench::report("20k bodies spatial grid query_pairs", pairs_ns / FRAMES);
+    bench::report("20k bodies spatial grid query_rect per moved body", rect_ns / (FRAMES * MOVED_PER_FRAME));
+    bench::report("20k bodies brute force pairs", brute_force_ns);
+    std::cout << "20k bodies overlapping pairs, grid: " << pair_count << ", brute force: " << brute_force_count << std::endl;
+}
@@ -0,0 +1,112 @@
+#include "bench.hpp"
+#include "ecs.hpp"
+
+#include <vector>
+
+namespace {
+    typedef struct Sparse {
+        float value;
+    } Sparse;
+}
+
+void run_world_benchmarks() {
+    const ecs::Entity ENTITY_COUNT = 1000000;
+
+    ecs::ECS ecs(ENTITY_COUNT);
+    ecs.register_component<Position>();
+    ecs.register_component<Sparse>();
+    std::vector<ecs::Entity> entities;
+    entities.reserve(ENTITY_COUNT);
+
+    double create_ns = bench::time_ns([&]() {
+        for(ecs::Entity i = 0; i < ENTITY_COUNT; i++) {
+            entities.push_back(ecs.create_entity());
+        }
+    });
+
+    // Only one in a hundred entities gets the sparse component
+    double add_ns = bench::time_ns([&]() {
+        for(ecs::Entity i = 0; i < ENTITY_COUNT; i++) {
+            ecs.add_component<Position>(entities[i], (Position) { .x = (float)i, .y = 0.0f });
+            if(i % 100 == 1) {
+                ecs.add_component<Sparse>(entities[i], (Sparse) { .value = (float)i });
+            }
+        }
+    });
+
+    // Free every other entity and respawn into the fragmented world
+    double remove_ns = bench::time_ns([&]() {
+        for(ecs::Entity i = 0; i < ENTITY_COUNT; i += 2) {
+            ecs.remove_entity(entities[i]);
+        }
+    });
+    double recreate_ns = bench::time_ns([&]() {
+        for(ecs::Entity i = 0; i < ENTITY_COUNT; i += 2) {
+            entities[i] = ecs.create_entity();
+        }
+    });
+
+    // The first view builds the group, after that a view only visits its members
+    double first_view_ns = bench::time_ns([&]() {
+        bench::do_not_optimize(ecs.view<Sparse>().size());
+    });
+
+    const int VIEW_ROUNDS = 1000;
+    std::size_t sparse_visited = 0;
+    double sparse_view_ns = bench::time_ns([&]() {
+        for(int round = 0; round < VIEW_ROUNDS; round++) {
+            for(ecs::Entity e : ecs.view<Sparse>()) {
+                bench::do_not_optimize(e);
+                sparse_visited++;
+            }
+        }
+    });
+
+    // Compare the per entity cost of a get_component loop against a typed each
+    std::size_t position_count = ecs.view<Position>().size();
+    double get_loop_ns = bench::time_ns([&]() {
+        for(ecs::Entity e : ecs.view<Position>()) {
+            ecs.get_component<Position>(e).x += 1.0f;
+        }
+    });
+    ecs::ComponentStorage<Position>& position_storage = ecs.storage<Position>();
+    double storage_loop_ns = bench::time_ns([&]() {
+        for(ecs::Entity e : ecs.view<Position>()) {
+            position_storage.get_component(e).x += 1.0f;
+        }
+    });
+    double each_ns = bench::time_ns([&]() {
+        ecs.view<Position>().each([](Position& position) {
+            position.x += 1.0f;
+        });
+    });
+
+    // The same spawn through the bulk paths, into a fresh world
+    ecs::ECS bulk_ecs(ENTITY_COUNT);
+    bulk_ecs.register_component<Position>();
+    std::vector<Position> positions;
+    positions.reserve(ENTITY_COUNT);
+    for(ecs::Entity i = 0; i < ENTITY_COUNT; i++) {
+        positions.push_back((Position) { .x = (float)i, .y = 0.0f });
+    }
+
+    std::vector<ecs::Entity> bulk_entities;
+    double bulk_create_ns = bench::time_ns([&]() {
+        bulk_entities = bulk_ecs.create_entities(ENTITY_COUNT);
+    });
+    double bulk_add_ns = bench::time_ns([&]() {
+        bulk_ecs.add_components<Position>(bulk_entities, positions);
+    });
+
+    bench::report("1M world create_entity", create_ns / ENTITY_COUNT);
+    bench::report("1M world add_component", add_ns / ENTITY_COUNT);
+    bench::report("1M world remove_entity", remove_ns / (ENTITY_COUNT / 2));
+    bench::report("1M world create_entity (fragmented)", recreate_ns / (ENTITY_COUNT / 2));
+    bench::report("1M world create_entities", bulk_create_ns / ENTITY_COUNT);
+    bench::report("1M world add_components<Position>", bulk_add_ns / ENTITY_COUNT);
+    bench::report("1M world first view<Sparse>", first_view_ns);
+    bench::report("1M world view<Sparse> iteration per entity", sparse_view_ns / sparse_visited);
+    bench::report("1M world view<Position> get_component loop per entity", get_loop_ns / position_count);
+    bench::report("1M world view<Position> storage get_component loop per entity", storage_loop_ns / position_count);
+    bench::report("1M world view<Position> each per entity", each_ns / position_count);
+}
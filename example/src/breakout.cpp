@@ -2,16 +2,20 @@
 
 #include "render.hpp"
 
-typedef vec2 Velocity;
-typedef struct Face {
-    SDL_Rect rect;
-    SDL_Color color;
-} Face;
-
 const int PLAYER_SPEED = 3;
 const int BALL_SPEED = 3;
+const float GRID_CELL_SIZE = 64.0f;
+
+static ecs::Bounds face_bounds(const Face& face) {
+    return (ecs::Bounds) {
+        .min_x = (float)face.rect.x,
+        .min_y = (float)face.rect.y,
+        .max_x = (float)(face.rect.x + face.rect.w),
+        .max_y = (float)(face.rect.y + face.rect.h)
+    };
+}
 
-Breakout::Breakout() {
+Breakout::Breakout() : commands(ecs), face_grid(ecs, GRID_CELL_SIZE, face_bounds) {
     ecs.register_component<Velocity>();
     ecs.register_component<Face>();
 
@@ -82,62 +86,63 @@ void Breakout::update() {
         return;
     }
 
-    ecs::View movement_view = ecs.view<Face, Velocity>();
-    for(ecs::Entity e : movement_view) {
-        Face& face = ecs.get_component<Face>(e);
-        Velocity& velocity = ecs.get_component<Velocity>(e);
+    // Faces are split into member arrays, so movement only touches the rects and leaves the colors alone
+    ecs.view<Face, Velocity>().each([this](ecs::Entity e, ecs::SoaReference<Face> face, Velocity& velocity) {
+        SDL_Rect& rect = face.get<&Face::rect>();
 
         // Increment the entity's position
-        face.rect.x += velocity.x;
-        face.rect.y += velocity.y;
+        rect.x += velocity.x;
+        rect.y += velocity.y;
 
         // Check to ensure entity stays in the screen
-        bool reached_x_bounds = face.rect.x < 0 || face.rect.x + face.rect.w > SCREEN_WIDTH;
+        bool reached_x_bounds = rect.x < 0 || rect.x + rect.w > SCREEN_WIDTH;
         if(reached_x_bounds && e == player) {
-            face.rect.x -= velocity.x;
+            rect.x -= velocity.x;
         } else if(reached_x_bounds && e == ball) {
             velocity.x *= -1;
         }
 
-        if(e == ball && face.rect.y < 0) {
+        if(e == ball && rect.y < 0) {
             velocity.y *= -1;
-        } else if(e == ball && face.rect.y + face.rect.h > SCREEN_HEIGHT) {
+        } else if(e == ball && rect.y + rect.h > SCREEN_HEIGHT) {
             set_state(READY);
         }
-    }
+    });
 
-    ecs::View collision_view = ecs.view<Face>();
-    SDL_Rect ball_rect = ecs.get_component<Face>(ball).rect;
-    for(ecs::Entity e : collision_view) {
-        if(e == ball) {
-            continue;
+    // Only the ball and the player moved, so only they are updated in the grid
+    face_grid.update();
+
+    SDL_Rect ball_rect = ecs.get_component<const Face>(ball).get<&Face::rect>();
+    Velocity& ball_velocity = ecs.get_component<Velocity>(ball);
+
+    SDL_Rect player_rect = ecs.get_component<const Face>(player).get<&Face::rect>();
+    if(rects_intersect(ball_rect, player_rect)) {
+        ball_velocity.y *= -1;
+        bool ball_on_player_left_side = ball_rect.x + ball_rect.w < player_rect.x + (player_rect.w / 2);
+        if( (ball_on_player_left_side && ball_velocity.x < 0) ||
+            (!ball_on_player_left_side && ball_velocity.x > 0)) {
+            ball_velocity.x *= -1;
         }
+    }
 
-        SDL_Rect entity_rect = ecs.get_component<Face>(e).rect;
-        if(rects_intersect(ball_rect, entity_rect)) {
-            Velocity& ball_velocity = ecs.get_component<Velocity>(ball);
+    // Bricks are the only entities which don't move. The grid only hands back the entities near the ball.
+    ecs::ComponentStorage<Velocity>& velocities = ecs.storage<Velocity>();
+    face_grid.query_rect(face_bounds(ecs.get_component<const Face>(ball)), [this, &velocities, &ball_velocity](ecs::Entity e) {
+        if(!velocities.has_component(e)) {
             ball_velocity.y *= -1;
-            if(e == player) {
-                bool ball_on_player_left_side = ball_rect.x + ball_rect.w < entity_rect.x + (entity_rect.w / 2);
-                if( (ball_on_player_left_side && ball_velocity.x < 0) ||
-                    (!ball_on_player_left_side && ball_velocity.x > 0)) {
-                    ball_velocity.x *= -1;
-                }
-            } else {
-                ecs.remove_entity(e);
-            }
+            commands.remove_entity(e);
         }
-    }
+    });
+    commands.flush();
+    ecs.advance_tick();
 }
 
 void Breakout::render() {
-    ecs::View render_view = ecs.view<Face>();
-    for(ecs::Entity e : render_view) {
-        Face entity_face = ecs.get_component<Face>(e);
-
-        SDL_SetRenderDrawColor(renderer, entity_face.color.r, entity_face.color.g, entity_face.color.b, 255);
-        SDL_RenderFillRect(renderer, &entity_face.rect);
-    }
+    ecs.view<const Face>().each([](ecs::SoaReference<const Face> entity_face) {
+        const SDL_Color& color = entity_face.get<&Face::color>();
+        SDL_SetRenderDrawColor(renderer, color.r, color.g, color.b, 255);
+        SDL_RenderFillRect(renderer, &entity_face.get<&Face::rect>());
+    });
 
     if(state == READY) {
         render_text("Press space to start!", FONT_HACK, COLOR_WHITE, (vec2) { .x = RENDER_POSITION_CENTERED, .y = 150 });
@@ -152,12 +157,11 @@ void Breakout::set_state(State new_state) {
     state = new_state;
     if(state == READY) {
         // Remoe any existing bricks
-        ecs::View brick_view = ecs.view<Face>();
+        ecs::View brick_view = ecs.view<Face>(ecs::exclude<Velocity>);
         for(ecs::Entity e : brick_view) {
-            if(e != player && e != ball) {
-                ecs.remove_entity(e);
-            }
+            commands.remove_entity(e);
         }
+        commands.flush();
 
         // Reset player and ball position
         player_reset_position();
@@ -182,9 +186,9 @@ void Breakout::player_create() {
 }
 
 void Breakout::player_reset_position() {
-    Face& player_face = ecs.get_component<Face>(player);
-    player_face.rect.x = (SCREEN_WIDTH / 2) - (player_face.rect.w / 2);
-    player_face.rect.y = SCREEN_HEIGHT - player_face.rect.h - 5;
+    SDL_Rect& player_rect = ecs.get_component<Face>(player).get<&Face::rect>();
+    player_rect.x = (SCREEN_WIDTH / 2) - (player_rect.w / 2);
+    player_rect.y = SCREEN_HEIGHT - player_rect.h - 5;
 }
 
 void Breakout::ball_create() {
@@ -197,9 +201,9 @@ void Breakout::ball_create() {
 }
 
 void Breakout::ball_reset_position() {
-    Face& ball_face = ecs.get_component<Face>(ball);
-    ball_face.rect.x = (SCREEN_WIDTH / 2) - (ball_face.rect.w / 2);
-    ball_face.rect.y = (SCREEN_HEIGHT / 2) - (ball_face.rect.h / 2);
+    SDL_Rect& ball_rect = ecs.get_component<Face>(ball).get<&Face::rect>();
+    ball_rect.x = (SCREEN_WIDTH / 2) - (ball_rect.w / 2);
+    ball_rect.y = (SCREEN_HEIGHT / 2) - (ball_rect.h / 2);
 }
 
 void Breakout::create_bricks() {
@@ -208,6 +212,7 @@ void Breakout::create_bricks() {
     const int OFFSET = 25;
     const int NUMBER_OF_ROWS = 5;
 
+    std::vector<Face> brick_faces;
     for(int row = 0; row < NUMBER_OF_ROWS; row++) {
         vec2 brick_position = BRICK_PADDING + (vec2) { .x = 0, .y = ((BRICK_SIZE.y + BRICK_PADDING.y) * row) };
         int row_max = SCREEN_WIDTH;
@@ -217,8 +222,7 @@ void Breakout::create_bricks() {
         }
 
         while(brick_position.x + BRICK_SIZE.x < row_max) {
-            ecs::Entity new_brick = ecs.create_entity();
-            ecs.add_component<Face>(new_brick, (Face) {
+            brick_faces.push_back((Face) {
                 .rect = (SDL_Rect) {
                     .x = brick_position.x,
                     .y = brick_position.y,
@@ -231,4 +235,7 @@ void Breakout::create_bricks() {
             brick_position.x += BRICK_SIZE.x + BRICK_PADDING.x;
         }
     }
+
+    std::vector<ecs::Entity> bricks = ecs.create_entities(brick_faces.size());
+    ecs.add_components<Face>(bricks, brick_faces);
 }
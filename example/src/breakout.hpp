@@ -4,6 +4,17 @@
 #include "ecs.hpp"
 #include "vector.hpp"
 
+typedef vec2 Velocity;
+typedef struct Face {
+    SDL_Rect rect;
+    SDL_Color color;
+} Face;
+
+template<>
+struct ecs::SoaLayout<Face> {
+    static constexpr auto members = std::make_tuple(&Face::rect, &Face::color);
+};
+
 class Breakout {
     typedef enum State {
         READY,
@@ -22,6 +33,8 @@ class Breakout {
         void render();
     private:
         ecs::ECS ecs;
+        ecs::CommandBuffer commands;
+        ecs::SpatialGrid<Face> face_grid;
 
         State state;
         bool player_input_held[2];
@@ -10,218 +10,3833 @@
         } \
     } while (false)
 #else
-#   define ASSERT(condition, message) do { } while (false)
+#   define ecs_assert(condition, message) do { } while (false)
 #endif
 
+// Like ecs_assert, but also checked in release builds, for mistakes which would otherwise corrupt the world
+#define ecs_check(condition, message) \
+    do { \
+        if (! (condition)) { \
+            std::cerr << "Check `" #condition "` failed in " << __FILE__ \
+                      << " line " << __LINE__ << ": " << message << std::endl; \
+            std::terminate(); \
+        } \
+    } while (false)
+
 #include <cstdint>
+#if (defined(__AVX2__) || defined(__SSE2__)) && !defined(ECS_NO_SIMD)
+#   include <immintrin.h>
+#endif
+#include <algorithm>
 #include <array>
-#include <queue>
-#include <unordered_map>
+#include <atomic>
+#include <bit>
+#include <cmath>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <optional>
 #include <set>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <typeinfo>
+#include <vector>
 #include <iostream>
 
 namespace ecs {
-    const std::uint32_t MAX_ENTITIES = 4096;
-    const std::uint8_t MAX_COMPONENTS = 32;
+    const std::uint16_t MAX_COMPONENTS = 256;
+    const std::uint32_t SPARSE_PAGE_SIZE = 1024;
+    const std::uint32_t ENTITY_CHUNK_SIZE = 4096;
+    const std::uint32_t MIN_ENTITY_CAPACITY = 64;
+    const std::size_t CACHE_LINE_SIZE = 64;
+    const std::size_t PARALLEL_GRAIN_SIZE = 1024;
+
+    // An entity handle packs the entity's slot index into the low bits and the slot's generation into the high bits.
+    // The generation is bumped every time the slot is freed, so handles to removed entities never alias the entity
+    // that reuses the slot.
+    const std::uint32_t ENTITY_INDEX_BITS = 22;
+    const std::uint32_t ENTITY_INDEX_MASK = (1u << ENTITY_INDEX_BITS) - 1;
+    const std::uint32_t ENTITY_GENERATION_MASK = (1u << (32 - ENTITY_INDEX_BITS)) - 1;
+    const std::uint32_t MAX_ENTITIES = ENTITY_INDEX_MASK + 1;
+
+    // Living entities never use the last generation. Command buffers use it to mark placeholders for entities which
+    // haven't been created yet.
+    const std::uint32_t PENDING_GENERATION = ENTITY_GENERATION_MASK;
 
     using Entity = std::uint32_t;
-    using ComponentType = std::uint8_t;
-    using Signature = std::bitset<MAX_COMPONENTS>;
-    using View = std::vector<ecs::Entity>;
+    using ComponentType = std::uint16_t;
 
-    class IComponentArray {
-        public:
-            virtual ~IComponentArray() = default;
-            virtual void handle_entity_removed(Entity entity) = 0;
-    };
+    using TypeHash = std::uint64_t;
+
+    // The world's change counter. Component arrays stamp components with the tick at which they were added and last
+    // accessed mutably.
+    using Tick = std::uint32_t;
 
+    // Gives a component type a stable name to hash instead of the compiler's spelling of it. Types spelled the same way
+    // hash the same, so two types with internal linkage and the same name, such as (anonymous namespace)::Health in two
+    // files, must either get different names here or not be registered in the same world. A name also keeps snapshots
+    // loadable after the type is renamed or moved to another namespace.
+    //     template<>
+    //     struct ecs::TypeName<Health> {
+    //         static constexpr std::string_view value = "game::Health";
+    //     };
     template<typename T>
-    class ComponentArray : public IComponentArray {
-        public:
-            void insert_component(Entity entity, T component) {
-                ecs_assert(entity_to_index_map.find(entity) == entity_to_index_map.end(), "Cannot insert component. Entity already has component of this type.");
+    struct TypeName {};
 
-                size_t new_index = size;
-                entity_to_index_map[entity] = new_index;
-                index_to_entity_map[new_index] = entity;
-                values[new_index] = component;
-                size++;
-            }
+    // Hashes the type's TypeName, or else the compiler's spelling of the type's name, with FNV-1a at compile time.
+    // Unlike the typeid(T).name() pointer, the hash is the same in every shared library which sees the type, so plugins
+    // agree on a type's identity.
+    template<typename T>
+    constexpr TypeHash type_hash() {
+#if defined(_MSC_VER)
+        constexpr std::string_view spelling = __FUNCSIG__;
+#else
+        constexpr std::string_view spelling = __PRETTY_FUNCTION__;
+#endif
+        std::string_view name = spelling;
+        if constexpr(requires { TypeName<T>::value; }) {
+            name = TypeName<T>::value;
+        }
+        TypeHash hash = 14695981039346656037ull;
+        for(char c : name) {
+            hash ^= (TypeHash)(unsigned char)c;
+            hash *= 1099511628211ull;
+        }
 
-            void remove_component(Entity entity) {
-                ecs_assert(entity_to_index_map.find(entity) != entity_to_index_map.end(), "Cannot remove component. Entity doesn't have a component of this type.");
+        return hash;
+    }
 
-                // Swap removed component with the last component in the array, to ensure data remains tightly packed in the array
-                size_t index_of_removed_entity = entity_to_index_map[entity];
-                size_t index_of_last_component = size - 1;
-                values[index_of_removed_entity] = values[index_of_last_component];
+    inline std::size_t next_type_sequence() {
+        static std::atomic<std::size_t> next_sequence = 0;
+        return next_sequence++;
+    }
 
-                // Update the map to be consistent with the above swap
-                Entity entity_of_last_component = index_to_entity_map[index_of_last_component];
-                entity_to_index_map[entity_of_last_component] = index_of_removed_entity;
-                index_to_entity_map[index_of_removed_entity] = entity_of_last_component;
+    // Returns a small number unique to the type, handed out in the order types are first used. The ECS uses it to
+    // index a flat table instead of hashing. A plugin which doesn't share this counter with the host may hand out
+    // different numbers, so the ECS double checks each table entry against the type's hash.
+    template<typename T>
+    std::size_t type_sequence() {
+        static const std::size_t sequence = next_type_sequence();
+        return sequence;
+    }
+
+    inline std::uint32_t entity_index(Entity entity) {
+        return entity & ENTITY_INDEX_MASK;
+    }
+
+    inline std::uint32_t entity_generation(Entity entity) {
+        return entity >> ENTITY_INDEX_BITS;
+    }
+
+    inline Entity make_entity(std::uint32_t index, std::uint32_t generation) {
+        return (generation << ENTITY_INDEX_BITS) | index;
+    }
 
-                entity_to_index_map.erase(entity);
-                index_to_entity_map.erase(index_of_last_component);
+    // One bit per component type, stored as plain 64-bit words. A signature is aligned so that it loads into a single
+    // AVX2 register, and contains() tests a whole signature with one vptest under AVX2, two 128-bit compares under
+    // SSE2, or word by word otherwise. Define ECS_NO_SIMD to force the word by word version.
+    class alignas(32) Signature {
+        public:
+            static const std::size_t WORD_COUNT = MAX_COMPONENTS / 64;
 
-                size--;
+            Signature() {
+                words.fill(0);
             }
 
-            T& get_component(Entity entity) {
-                ecs_assert(entity_to_index_map.find(entity) != entity_to_index_map.end(), "Cannot get component data. Entity doesn't have a component of this type.");
+            void set(ComponentType type) {
+                words[type / 64] |= 1ull << (type % 64);
+            }
 
-                return values[entity_to_index_map[entity]];
+            void reset(ComponentType type) {
+                words[type / 64] &= ~(1ull << (type % 64));
             }
 
-            void handle_entity_removed(Entity entity) override {
-                bool entity_had_component_of_this_type = entity_to_index_map.find(entity) != entity_to_index_map.end();
+            void reset() {
+                words.fill(0);
+            }
 
-                if(entity_had_component_of_this_type) {
-                    remove_component(entity);
+            bool test(ComponentType type) const {
+                return (words[type / 64] >> (type % 64)) & 1;
+            }
+
+            bool any() const {
+                for(std::uint64_t word : words) {
+                    if(word != 0) {
+                        return true;
+                    }
                 }
+
+                return false;
             }
-        private:
-            std::array<T, MAX_ENTITIES> values;
-            std::unordered_map<Entity, size_t> entity_to_index_map;
-            std::unordered_map<size_t, Entity> index_to_entity_map;
-            std::size_t size;
-    };
 
-    class ECS {
-        public:
-            ECS() {
-                entity_array_count = 0;
-                component_arrays_count = 0;
+            bool none() const {
+                return !any();
+            }
 
-                for(Entity i = 0; i < MAX_ENTITIES; i++) {
-                    entity_living[i] = false;
+            // Returns whether every bit set in other is also set in this signature
+            bool contains(const Signature& other) const {
+#if defined(__AVX2__) && !defined(ECS_NO_SIMD)
+                __m256i these_words = _mm256_load_si256((const __m256i*)words.data());
+                __m256i other_words = _mm256_load_si256((const __m256i*)other.words.data());
+                return _mm256_testc_si256(these_words, other_words);
+#elif defined(__SSE2__) && !defined(ECS_NO_SIMD)
+                for(std::size_t word = 0; word < WORD_COUNT; word += 2) {
+                    __m128i these_words = _mm_load_si128((const __m128i*)(words.data() + word));
+                    __m128i other_words = _mm_load_si128((const __m128i*)(other.words.data() + word));
+                    __m128i equal = _mm_cmpeq_epi8(_mm_and_si128(these_words, other_words), other_words);
+                    if(_mm_movemask_epi8(equal) != 0xFFFF) {
+                        return false;
+                    }
+                }
+
+                return true;
+#else
+                for(std::size_t word = 0; word < WORD_COUNT; word++) {
+                    if((words[word] & other.words[word]) != other.words[word]) {
+                        return false;
+                    }
                 }
+
+                return true;
+#endif
             }
 
-            Entity create_entity() {
-                ecs_assert(entity_array_count < MAX_ENTITIES, "Entity array is full.");
+            // Returns whether any bit is set in both signatures
+            bool intersects(const Signature& other) const {
+#if defined(__AVX2__) && !defined(ECS_NO_SIMD)
+                __m256i these_words = _mm256_load_si256((const __m256i*)words.data());
+                __m256i other_words = _mm256_load_si256((const __m256i*)other.words.data());
+                return !_mm256_testz_si256(these_words, other_words);
+#elif defined(__SSE2__) && !defined(ECS_NO_SIMD)
+                for(std::size_t word = 0; word < WORD_COUNT; word += 2) {
+                    __m128i these_words = _mm_load_si128((const __m128i*)(words.data() + word));
+                    __m128i other_words = _mm_load_si128((const __m128i*)(other.words.data() + word));
+                    __m128i zero = _mm_cmpeq_epi8(_mm_and_si128(these_words, other_words), _mm_setzero_si128());
+                    if(_mm_movemask_epi8(zero) != 0xFFFF) {
+                        return true;
+                    }
+                }
 
-                for(Entity e = 0; e < MAX_ENTITIES; e++) {
-                    if(entity_living[e]) {
-                        continue;
+                return false;
+#else
+                for(std::size_t word = 0; word < WORD_COUNT; word++) {
+                    if((words[word] & other.words[word]) != 0) {
+                        return true;
                     }
-                    entity_living[e] = true;
-                    entity_array_count++;
-                    return e;
                 }
 
-                ecs_assert(false, "All entity living flags are true even though the entity array count isn't at max.");
-                return 0;
+                return false;
+#endif
             }
 
-            void remove_entity(Entity entity_to_remove) {
-                ecs_assert(entity_to_remove < MAX_ENTITIES, "Cannot remove entity. Entity out of range.");
+            std::uint64_t get_word(std::size_t word) const {
+                return words[word];
+            }
 
-                entity_living[entity_to_remove] = false;
-                entity_signatures[entity_to_remove].reset();
+            void set_word(std::size_t word, std::uint64_t value) {
+                words[word] = value;
+            }
 
-                // Notify each component array that an entity has been destroyed
-                for(auto const& pair : component_arrays) {
-                    auto const& component_array = pair.second;
-                    component_array->handle_entity_removed(entity_to_remove);
+            Signature operator&(const Signature& other) const {
+                Signature result;
+                for(std::size_t word = 0; word < WORD_COUNT; word++) {
+                    result.words[word] = words[word] & other.words[word];
                 }
 
-                entity_array_count--;
+                return result;
             }
 
-            Signature get_entity_signature(Entity entity) {
-                ecs_assert(entity < MAX_ENTITIES, "Cannot get entity signature. Entity out of range.");
+            Signature operator|(const Signature& other) const {
+                Signature result;
+                for(std::size_t word = 0; word < WORD_COUNT; word++) {
+                    result.words[word] = words[word] | other.words[word];
+                }
+
+                return result;
+            }
+
+            bool operator==(const Signature& other) const {
+                return words == other.words;
+            }
+
+            bool operator!=(const Signature& other) const {
+                return words != other.words;
+            }
+        private:
+            std::array<std::uint64_t, WORD_COUNT> words;
+    };
+
+    // Calls on_match with the index of every signature in the array which contains the required signature and shares
+    // no bits with the excluded signature. Most queries only involve a few component types, so only the words which
+    // have bits set in either signature are compared. A signature matches when masking each of those words with
+    // required | excluded leaves exactly the required bits. Under AVX2 the words are gathered from four signatures at a
+    // time and tested with one compare. SSE2 has neither gathers nor 64 bit compares, so there the words of four
+    // signatures are loaded into two registers, compared as 32 bit halves, and a word matches when both halves do.
+    template<typename Function>
+    void match_signatures(const Signature* signatures, std::size_t count, const Signature& required, const Signature& excluded, Function on_match) {
+        Signature tested = required | excluded;
+
+        std::array<std::size_t, Signature::WORD_COUNT> required_words;
+        std::size_t required_word_count = 0;
+        for(std::size_t word = 0; word < Signature::WORD_COUNT; word++) {
+            if(tested.get_word(word) != 0) {
+                required_words[required_word_count++] = word;
+            }
+        }
+
+        std::size_t i = 0;
+#if defined(__AVX2__) && !defined(ECS_NO_SIMD)
+        const long long WORDS_PER_SIGNATURE = sizeof(Signature) / sizeof(std::uint64_t);
+        const __m256i gather_offsets = _mm256_setr_epi64x(0, WORDS_PER_SIGNATURE, 2 * WORDS_PER_SIGNATURE, 3 * WORDS_PER_SIGNATURE);
+        const long long* base = (const long long*)signatures;
+
+        for(; i + 4 <= count; i += 4) {
+            __m256i all_match = _mm256_set1_epi64x(-1);
+            for(std::size_t w = 0; w < required_word_count; w++) {
+                std::size_t word = required_words[w];
+                __m256i mask = _mm256_set1_epi64x((long long)tested.get_word(word));
+                __m256i expected = _mm256_set1_epi64x((long long)required.get_word(word));
+                __m256i gathered = _mm256_i64gather_epi64(base + i * WORDS_PER_SIGNATURE + word, gather_offsets, 8);
+                all_match = _mm256_and_si256(all_match, _mm256_cmpeq_epi64(_mm256_and_si256(gathered, mask), expected));
+            }
+
+            int match_bits = _mm256_movemask_pd(_mm256_castsi256_pd(all_match));
+            while(match_bits != 0) {
+                int lane = std::countr_zero((unsigned int)match_bits);
+                on_match(i + lane);
+                match_bits &= match_bits - 1;
+            }
+        }
+#elif defined(__SSE2__) && !defined(ECS_NO_SIMD)
+        for(; i + 4 <= count; i += 4) {
+            __m128i first_match = _mm_set1_epi32(-1);
+            __m128i second_match = _mm_set1_epi32(-1);
+            for(std::size_t w = 0; w < required_word_count; w++) {
+                std::size_t word = required_words[w];
+                __m128i mask = _mm_set1_epi64x((long long)tested.get_word(word));
+                __m128i expected = _mm_set1_epi64x((long long)required.get_word(word));
+                __m128i first = _mm_set_epi64x((long long)signatures[i + 1].get_word(word), (long long)signatures[i].get_word(word));
+                __m128i second = _mm_set_epi64x((long long)signatures[i + 3].get_word(word), (long long)signatures[i + 2].get_word(word));
+                first_match = _mm_and_si128(first_match, _mm_cmpeq_epi32(_mm_and_si128(first, mask), expected));
+                second_match = _mm_and_si128(second_match, _mm_cmpeq_epi32(_mm_and_si128(second, mask), expected));
+            }
+
+            // Swapping the halves of each word and combining leaves a word's high half set only if both halves matched
+            first_match = _mm_and_si128(first_match, _mm_shuffle_epi32(first_match, _MM_SHUFFLE(2, 3, 0, 1)));
+            second_match = _mm_and_si128(second_match, _mm_shuffle_epi32(second_match, _MM_SHUFFLE(2, 3, 0, 1)));
+            int match_bits = _mm_movemask_pd(_mm_castsi128_pd(first_match)) | (_mm_movemask_pd(_mm_castsi128_pd(second_match)) << 2);
+            while(match_bits != 0) {
+                int lane = std::countr_zero((unsigned int)match_bits);
+                on_match(i + lane);
+                match_bits &= match_bits - 1;
+            }
+        }
+#endif
+        for(; i < count; i++) {
+            bool matches = true;
+            for(std::size_t w = 0; w < required_word_count && matches; w++) {
+                std::size_t word = required_words[w];
+                matches = (signatures[i].get_word(word) & tested.get_word(word)) == required.get_word(word);
+            }
+            if(matches) {
+                on_match(i);
+            }
+        }
+    }
+
+    template<typename Function>
+    void match_signatures(const Signature* signatures, std::size_t count, const Signature& required, Function on_match) {
+        match_signatures(signatures, count, required, Signature(), on_match);
+    }
+
+    // A snapshot is a header followed by sections: the entity slots' generations, living flags and signatures, the
+    // free slot queue, then one block per component type. A signature is stored as only as many 64 bit words as the
+    // registered component types need. A component block is a SnapshotComponentHeader followed by
+    // the component array's dense entities, added ticks, changed ticks and values. Every header and section starts at
+    // an offset which is a multiple of SNAPSHOT_ALIGNMENT, so when the snapshot itself is suitably aligned, as a
+    // mapped file is, each dense array can be read in place. Numbers are stored in the machine's native byte order.
+    const std::uint32_t SNAPSHOT_MAGIC = 0x53534345;
+    const std::uint32_t SNAPSHOT_VERSION = 1;
+    const std::size_t SNAPSHOT_ALIGNMENT = CACHE_LINE_SIZE;
+
+    struct SnapshotHeader {
+        std::uint32_t magic;
+        std::uint32_t version;
+        std::uint32_t slot_count;
+        std::uint32_t next_unused_index;
+        std::uint32_t free_count;
+        std::uint32_t living_count;
+        Tick tick;
+        std::uint32_t component_count;
+    };
+
+    // Components of trivially copyable types are stored as their raw bytes, value_size bytes each. Other types are
+    // written by the serializer registered for them and have a value_size of 0.
+    struct SnapshotComponentHeader {
+        TypeHash hash;
+        std::uint64_t value_bytes;
+        std::uint32_t count;
+        std::uint32_t value_size;
+    };
+
+    // A delta holds what changed in a world since a baseline snapshot of it, and uses the same section layout as a
+    // snapshot. The header is followed by the entity slots whose generation or living flag differ from the baseline
+    // and the whole free slot queue. Then comes one block for each component type with changes, holding the
+    // entities which lost the component while staying alive, the entities whose component was added or changed, and
+    // those components' values.
+    const std::uint32_t DELTA_MAGIC = 0x44534345;
+    const std::uint32_t DELTA_VERSION = 1;
+
+    struct DeltaHeader {
+        std::uint32_t magic;
+        std::uint32_t version;
+        Tick baseline_tick;
+        Tick tick;
+        std::uint32_t slot_count;
+        std::uint32_t next_unused_index;
+        std::uint32_t free_count;
+        std::uint32_t living_count;
+        std::uint32_t slot_change_count;
+        std::uint32_t component_count;
+    };
+
+    struct DeltaSlot {
+        std::uint32_t index;
+        std::uint32_t generation;
+        std::uint32_t living;
+    };
 
-                return entity_signatures[entity];
+    struct DeltaComponentHeader {
+        TypeHash hash;
+        std::uint64_t value_bytes;
+        std::uint32_t removed_count;
+        std::uint32_t changed_count;
+        std::uint32_t value_size;
+        std::uint32_t reserved;
+    };
+
+    // Appends snapshot data to a byte buffer
+    class SnapshotWriter {
+        public:
+            SnapshotWriter(std::vector<std::byte>& buffer) : buffer(buffer) {}
+
+            void write(const void* data, std::size_t size) {
+                const std::byte* bytes = static_cast<const std::byte*>(data);
+                buffer.insert(buffer.end(), bytes, bytes + size);
             }
 
             template<typename T>
-            void register_component() {
-                const char* type_name = typeid(T).name();
+            void write(const T& value) {
+                static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable values can be written as bytes.");
+                write(&value, sizeof(T));
+            }
 
-                ecs_assert(component_types.find(type_name) == component_types.end(), "Cannot register component. Component type " + std::string(type_name) + " already registered.");
+            // Pads the buffer to the next section boundary, then writes the data
+            void write_section(const void* data, std::size_t size) {
+                buffer.resize((buffer.size() + SNAPSHOT_ALIGNMENT - 1) / SNAPSHOT_ALIGNMENT * SNAPSHOT_ALIGNMENT);
+                write(data, size);
+            }
 
-                component_types.insert({type_name, component_arrays_count});
-                component_arrays.insert({type_name, std::make_shared<ComponentArray<T>>()});
+            // Pads the buffer to the next section boundary and appends a section of size bytes for the caller to fill in
+            std::span<std::byte> reserve_section(std::size_t size) {
+                write_section(nullptr, 0);
+                std::size_t offset = buffer.size();
+                buffer.resize(offset + size);
 
-                component_arrays_count++;
+                return std::span<std::byte>(buffer.data() + offset, size);
             }
 
+            // Overwrites a value written earlier, at the given offset from the start of the buffer
             template<typename T>
-            ComponentType get_component_type() {
-                const char* type_name = typeid(T).name();
+            void overwrite(std::size_t offset, const T& value) {
+                std::memcpy(buffer.data() + offset, &value, sizeof(T));
+            }
+
+            std::size_t size() const {
+                return buffer.size();
+            }
+        private:
+            std::vector<std::byte>& buffer;
+    };
 
-                ecs_assert(component_types.find(type_name) != component_types.end(), "Cannot get component type. Component of type " + std::string(type_name) + " not registered.");
+    // Reads snapshot data in the order SnapshotWriter wrote it. Snapshots may come from a file or the network, so a
+    // read past the end of the data or a misaligned section doesn't touch memory outside the data. It marks the reader
+    // as failed instead, and reads zeros and empty sections from then on.
+    class SnapshotReader {
+        public:
+            SnapshotReader(std::span<const std::byte> data) : data(data), position(0), failed(false) {}
 
-                return component_types[type_name];
+            void read(void* out, std::size_t size) {
+                if(failed || size > data.size() - position) {
+                    fail();
+                    if(size > 0) {
+                        std::memset(out, 0, size);
+                    }
+                    return;
+                }
+                if(size > 0) {
+                    std::memcpy(out, data.data() + position, size);
+                }
+                position += size;
             }
 
             template<typename T>
-            void add_component(Entity entity, T component) {
-                get_component_array<T>()->insert_component(entity, component);
-                entity_signatures[entity].set(get_component_type<T>());
+            T read() {
+                static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable values can be read as bytes.");
+                std::array<std::byte, sizeof(T)> bytes;
+                read(bytes.data(), sizeof(T));
+                return std::bit_cast<T>(bytes);
             }
 
+            // Skips to the next section boundary and returns the section's count elements in place, without copying
             template<typename T>
-            void remove_component(Entity entity) {
-                get_component_array<T>()->remove_component(entity);
-                entity_signatures[entity].reset(get_component_type<T>());
+            std::span<const T> section(std::size_t count) {
+                align();
+                const std::byte* start = data.data() + position;
+                if(failed || count > (data.size() - position) / sizeof(T) || (count > 0 && reinterpret_cast<std::uintptr_t>(start) % alignof(T) != 0)) {
+                    fail();
+                    return std::span<const T>();
+                }
+                position += count * sizeof(T);
+
+                return std::span<const T>(reinterpret_cast<const T*>(start), count);
             }
 
             template<typename T>
-            T& get_component(Entity entity) {
-                return get_component_array<T>()->get_component(entity);
+            T read_section() {
+                align();
+                return read<T>();
             }
 
-            template<typename ...rest>
-            View view() {
-                Signature system_signature;
-                get_system_signature<rest...>(system_signature);
+            // Whether every read so far stayed inside the data
+            bool ok() const {
+                return !failed;
+            }
+        private:
+            std::span<const std::byte> data;
+            std::size_t position;
+            bool failed;
 
-                std::vector<Entity> entity_list;
-                int number_of_entities_checked = 0;
-                for(Entity i = 0; i < MAX_ENTITIES; i++) {
-                    if(entity_living[i]) {
-                        if((entity_signatures[i] & system_signature) == system_signature) {
-                            entity_list.push_back(i);
-                        }
-                        number_of_entities_checked++;
-                    }
-                    if(number_of_entities_checked >= entity_array_count) {
-                        break;
+            void fail() {
+                failed = true;
+                position = data.size();
+            }
+
+            void align() {
+                position = std::min(data.size(), (position + SNAPSHOT_ALIGNMENT - 1) / SNAPSHOT_ALIGNMENT * SNAPSHOT_ALIGNMENT);
+            }
+    };
+
+    // Reads a snapshot in place, without loading it into a world. The component arrays of trivially copyable types are
+    // read straight out of the snapshot's memory, so inspecting a memory mapped snapshot copies nothing. A view of data
+    // which isn't a whole snapshot of a supported version is empty, and valid() returns false.
+    class SnapshotView {
+        public:
+            SnapshotView(std::span<const std::byte> snapshot) {
+                SnapshotReader reader(snapshot);
+                header = reader.read_section<SnapshotHeader>();
+                if(header.magic == SNAPSHOT_MAGIC && header.version == SNAPSHOT_VERSION) {
+                    generations = reader.section<std::uint32_t>(header.slot_count);
+                    living = reader.section<std::uint8_t>(header.slot_count);
+                    reader.section<std::uint64_t>((std::size_t)header.slot_count * ((header.component_count + 63) / 64));
+                    reader.section<std::uint32_t>(header.free_count);
+
+                    for(std::uint32_t i = 0; i < header.component_count && reader.ok(); i++) {
+                        ComponentSection component;
+                        component.header = reader.read_section<SnapshotComponentHeader>();
+                        component.entities = reader.section<Entity>(component.header.count);
+                        reader.section<Tick>(component.header.count);
+                        reader.section<Tick>(component.header.count);
+                        component.values = reader.section<std::byte>(component.header.value_bytes);
+                        sections.push_back(component);
                     }
                 }
 
-                return entity_list;
+                is_valid = header.magic == SNAPSHOT_MAGIC && header.version == SNAPSHOT_VERSION && reader.ok();
+                if(!is_valid) {
+                    header = SnapshotHeader();
+                    generations = {};
+                    living = {};
+                    sections.clear();
+                }
             }
-        private:
-            std::array<bool, MAX_ENTITIES> entity_living;
-            std::array<Signature, MAX_ENTITIES> entity_signatures;
-            Entity entity_array_count;
 
-            std::unordered_map<const char*, ComponentType> component_types;
-            std::unordered_map<const char*, std::shared_ptr<IComponentArray>> component_arrays;
-            ComponentType component_arrays_count;
+            bool valid() const {
+                return is_valid;
+            }
+
+            Tick get_tick() const {
+                return header.tick;
+            }
+
+            std::size_t entity_count() const {
+                return header.living_count;
+            }
+
+            // The generation and living flag of every entity slot, indexed by slot
+            std::span<const std::uint32_t> get_generations() const {
+                return generations;
+            }
+
+            std::span<const std::uint8_t> get_living() const {
+                return living;
+            }
+
+            bool is_alive(Entity entity) const {
+                std::uint32_t index = entity_index(entity);
+                return index < header.slot_count && living[index] && generations[index] == entity_generation(entity);
+            }
 
             template<typename T>
-            std::shared_ptr<ComponentArray<T>> get_component_array() {
-                const char* type_name = typeid(T).name();
+            bool has() const {
+                return find<T>() != nullptr;
+            }
 
-                ecs_assert(component_types.find(type_name) != component_types.end(), "Cannot get component array. Component of type " + std::string(type_name) + " not registered.");
+            // The owners of the components of type T, parallel to components<T>()
+            template<typename T>
+            std::span<const Entity> entities() const {
+                const ComponentSection* component = find<T>();
+                ecs_assert(component, "Cannot read snapshot. Snapshot has no components of type " + std::string(typeid(T).name()) + ".");
 
-                return std::static_pointer_cast<ComponentArray<T>>(component_arrays[type_name]);
+                return component->entities;
             }
 
             template<typename T>
-            void get_system_signature(Signature& signature) {
-                signature.set(get_component_type<T>());
+            std::span<const T> components() const {
+                static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable components can be read in place.");
+                const ComponentSection* component = find<T>();
+                ecs_assert(component, "Cannot read snapshot. Snapshot has no components of type " + std::string(typeid(T).name()) + ".");
+                ecs_assert(component->header.value_size == sizeof(T), "Cannot read snapshot. Components of type " + std::string(typeid(T).name()) + " were written by a serializer or have changed size.");
+
+                return SnapshotReader(component->values).section<T>(component->header.count);
             }
+        private:
+            struct ComponentSection {
+                SnapshotComponentHeader header;
+                std::span<const Entity> entities;
+                std::span<const std::byte> values;
+            };
 
-            template<typename T, typename U, typename... rest>
-            void get_system_signature(Signature& signature) {
-                get_system_signature<T>(signature);
-                get_system_signature<U, rest...>(signature);
+            SnapshotHeader header;
+            std::span<const std::uint32_t> generations;
+            std::span<const std::uint8_t> living;
+            std::vector<ComponentSection> sections;
+            bool is_valid;
+
+            template<typename T>
+            const ComponentSection* find() const {
+                for(auto const& component : sections) {
+                    if(component.header.hash == type_hash<T>()) {
+                        return &component;
+                    }
+                }
+
+                return nullptr;
+            }
+    };
+
+    class IComponentArray {
+        public:
+            virtual ~IComponentArray() = default;
+            virtual void handle_entity_removed(Entity entity) = 0;
+            virtual void notify_removed(Entity entity) = 0;
+            virtual std::size_t index_of(Entity entity) const = 0;
+            virtual void swap_dense(std::size_t a, std::size_t b) = 0;
+            virtual std::size_t size() const = 0;
+
+            // Destroys the array and returns its memory to the resource it was allocated from
+            virtual void destroy(std::pmr::memory_resource* resource) = 0;
+
+            // Writes the array as a component block of a snapshot, and replaces the array's contents with the block
+            // that follows the given header. Neither calls hooks.
+            virtual void save(SnapshotWriter& writer) const = 0;
+            virtual void load(SnapshotReader& reader, const SnapshotComponentHeader& header) = 0;
+            virtual void clear() = 0;
+
+            // Whether values saved with the given value size, starting at the given address, can be read back
+            virtual bool accepts(std::uint32_t value_size, const std::byte* values) const = 0;
+
+            // Writes a delta component block against the baseline's block for the same type, unless nothing changed,
+            // and returns whether it wrote one. Applying a block only inserts and overwrites components; the caller
+            // handles the removals and adds the inserted entities to added.
+            virtual bool save_delta(SnapshotWriter& writer, const SnapshotView& baseline, const std::function<bool(Entity)>& is_alive) const = 0;
+            virtual void apply_delta(SnapshotReader& reader, const DeltaComponentHeader& header, std::vector<Entity>& added) = 0;
+            virtual void notify_added(Entity entity) = 0;
+    };
+
+    // Maps entities to indices in a tightly packed dense array. The sparse pages are indexed by the entity's slot
+    // index and hold the entity's position in the dense array, so membership tests and lookups never hash.
+    class SparseSet {
+        public:
+            SparseSet(std::pmr::memory_resource* resource = std::pmr::get_default_resource()) : dense_entities(resource), sparse_pages(resource) {}
+
+            // Appends the entity to the dense array and returns its index
+            std::uint32_t insert(Entity entity) {
+                std::uint32_t index = (std::uint32_t)dense_entities.size();
+                sparse_index(entity) = index;
+                dense_entities.push_back(entity);
+
+                return index;
+            }
+
+            // Appends the entities to the dense array in order
+            void insert(std::span<const Entity> entities) {
+                std::uint32_t index = (std::uint32_t)dense_entities.size();
+                for(Entity entity : entities) {
+                    sparse_index(entity) = index++;
+                }
+                dense_entities.insert(dense_entities.end(), entities.begin(), entities.end());
+            }
+
+            // Removes every entity from the set
+            void clear() {
+                for(Entity entity : dense_entities) {
+                    sparse_index(entity) = NULL_INDEX;
+                }
+                dense_entities.clear();
+            }
+
+            // Swaps the last entity into the removed entity's place and returns that index, so that callers keeping
+            // arrays parallel to the dense array can do the same swap
+            std::uint32_t remove(Entity entity) {
+                std::uint32_t index_of_removed_entity = sparse_index(entity);
+                Entity entity_of_last_index = dense_entities.back();
+
+                dense_entities[index_of_removed_entity] = entity_of_last_index;
+                sparse_index(entity_of_last_index) = index_of_removed_entity;
+
+                sparse_index(entity) = NULL_INDEX;
+                dense_entities.pop_back();
+
+                return index_of_removed_entity;
+            }
+
+            // Swaps two entities' positions in the dense array
+            void swap(std::uint32_t a, std::uint32_t b) {
+                std::swap(dense_entities[a], dense_entities[b]);
+                sparse_index(dense_entities[a]) = a;
+                sparse_index(dense_entities[b]) = b;
+            }
+
+            // Compares the full handle stored in the dense array, so a stale handle whose slot has been reused
+            // isn't mistaken for the entity that reused it
+            bool contains(Entity entity) const {
+                std::uint32_t index = entity_index(entity);
+                std::size_t page = index / SPARSE_PAGE_SIZE;
+                if(page >= sparse_pages.size() || sparse_pages[page].empty()) {
+                    return false;
+                }
+
+                std::uint32_t dense_index = sparse_pages[page][index % SPARSE_PAGE_SIZE];
+                return dense_index != NULL_INDEX && dense_entities[dense_index] == entity;
+            }
+
+            // Returns the entity's index in the dense array. The entity must be in the set.
+            std::uint32_t index_of(Entity entity) const {
+                std::uint32_t index = entity_index(entity);
+                return sparse_pages[index / SPARSE_PAGE_SIZE][index % SPARSE_PAGE_SIZE];
+            }
+
+            std::size_t size() const {
+                return dense_entities.size();
+            }
+
+            const std::pmr::vector<Entity>& entities() const {
+                return dense_entities;
+            }
+        private:
+            static constexpr std::uint32_t NULL_INDEX = std::numeric_limits<std::uint32_t>::max();
+
+            // Pages which no entity has landed on yet are left empty. The pages get their memory from the same resource
+            // as the outer vector.
+            std::pmr::vector<Entity> dense_entities;
+            std::pmr::vector<std::pmr::vector<std::uint32_t>> sparse_pages;
+
+            // Returns the sparse slot for the entity, allocating its page if this is the first entity to land on it
+            std::uint32_t& sparse_index(Entity entity) {
+                std::uint32_t index = entity_index(entity);
+                std::size_t page = index / SPARSE_PAGE_SIZE;
+                if(page >= sparse_pages.size()) {
+                    sparse_pages.resize(page + 1);
+                }
+                if(sparse_pages[page].empty()) {
+                    sparse_pages[page].resize(SPARSE_PAGE_SIZE, NULL_INDEX);
+                }
+
+                return sparse_pages[page][index % SPARSE_PAGE_SIZE];
+            }
+    };
+
+    // Component types are stored as an array of structs unless they specialize SoaLayout. The specialization lists
+    // every data member of the type, and the type's component array then keeps each member in an array of its own, so
+    // a loop which only touches some members only pulls those through the cache. The type must be default
+    // constructible, and array members must be std::array.
+    //     template<>
+    //     struct ecs::SoaLayout<Particle> {
+    //         static constexpr auto members = std::make_tuple(&Particle::position, &Particle::velocity, &Particle::color);
+    //     };
+    template<typename T>
+    struct SoaLayout {};
+
+    template<typename T>
+    concept SoaComponent = requires { SoaLayout<T>::members; };
+
+    template<typename Member>
+    struct MemberPointer {};
+
+    template<typename T, typename M>
+    struct MemberPointer<M T::*> {
+        using type = M;
+    };
+
+    // The type of the data member a member pointer points to
+    template<auto Member>
+    using member_type = typename MemberPointer<decltype(Member)>::type;
+
+    template<typename T>
+    class SoaVector;
+
+    // Stands in for a reference to a component which is split into member arrays. get() returns a real reference to
+    // one member, and the proxy converts to and can be assigned from a whole component. A proxy for a const T only
+    // reads.
+    //     particle.get<&Particle::position>().x += 1.0f;
+    template<typename T>
+    class SoaReference {
+        using Value = std::remove_const_t<T>;
+        using Vector = std::conditional_t<std::is_const_v<T>, const SoaVector<Value>, SoaVector<Value>>;
+
+        public:
+            SoaReference(Vector* vector, std::size_t index) : vector(vector), index(index) {}
+            SoaReference(const SoaReference& other) = default;
+
+            operator SoaReference<const T>() const requires(!std::is_const_v<T>) {
+                return SoaReference<const T>(vector, index);
+            }
+
+            template<auto Member>
+            auto& get() const {
+                return vector->template column<Member>()[index];
+            }
+
+            operator Value() const {
+                return vector->load(index);
+            }
+
+            // Assigning to the proxy assigns to the component, including when assigning another proxy
+            SoaReference& operator=(Value value) {
+                vector->store(index, std::move(value));
+                return *this;
+            }
+
+            SoaReference& operator=(const SoaReference& other) {
+                return *this = (Value)other;
+            }
+
+            friend void swap(SoaReference a, SoaReference b) {
+                a.vector->swap(a.index, b.index);
+            }
+        private:
+            Vector* vector;
+            std::size_t index;
+    };
+
+    // The reference to a component which component arrays and views hand out, T& unless T is split into member
+    // arrays. T may be const.
+    template<typename T>
+    using ComponentReference = std::conditional_t<SoaComponent<std::remove_const_t<T>>, SoaReference<T>, T&>;
+
+    // Holds components split into one array per member listed in the type's SoaLayout, with enough of the interface
+    // of std::vector for a component array to use it in place of one. Indexing returns proxies instead of references.
+    template<typename T>
+    class SoaVector {
+        using Members = std::remove_const_t<decltype(SoaLayout<T>::members)>;
+        using Indices = std::make_index_sequence<std::tuple_size_v<Members>>;
+
+        public:
+            SoaVector(std::pmr::memory_resource* resource) : columns(make_columns(resource, Indices())) {}
+
+            // Returns the array holding the given member of every component
+            template<auto Member>
+            std::pmr::vector<member_type<Member>>& column() {
+                return std::get<member_index<Member>()>(columns);
+            }
+
+            template<auto Member>
+            const std::pmr::vector<member_type<Member>>& column() const {
+                return std::get<member_index<Member>()>(columns);
+            }
+
+            SoaReference<T> operator[](std::size_t index) {
+                return SoaReference<T>(this, index);
+            }
+
+            SoaReference<const T> operator[](std::size_t index) const {
+                return SoaReference<const T>(this, index);
+            }
+
+            SoaReference<T> back() {
+                return (*this)[size() - 1];
+            }
+
+            std::size_t size() const {
+                return std::get<0>(columns).size();
             }
 
+            void reserve(std::size_t capacity) {
+                std::apply([capacity](auto&... column) { (column.reserve(capacity), ...); }, columns);
+            }
+
+            void clear() {
+                std::apply([](auto&... column) { (column.clear(), ...); }, columns);
+            }
+
+            void pop_back() {
+                std::apply([](auto&... column) { (column.pop_back(), ...); }, columns);
+            }
+
+            void push_back(T value) {
+                [&]<std::size_t... I>(std::index_sequence<I...>) {
+                    (std::get<I>(columns).push_back(std::move(value.*std::get<I>(SoaLayout<T>::members))), ...);
+                }(Indices());
+            }
+
+            template<typename... Args>
+            void emplace_back(Args&&... args) {
+                push_back(T(std::forward<Args>(args)...));
+            }
+
+            template<typename Iterator>
+            void assign(Iterator first, Iterator last) {
+                clear();
+                reserve(std::distance(first, last));
+                for(; first != last; ++first) {
+                    push_back(*first);
+                }
+            }
+
+            // Gathers the component's members into a whole component
+            T load(std::size_t index) const {
+                T value;
+                [&]<std::size_t... I>(std::index_sequence<I...>) {
+                    ((value.*std::get<I>(SoaLayout<T>::members) = std::get<I>(columns)[index]), ...);
+                }(Indices());
+                return value;
+            }
+
+            void store(std::size_t index, T value) {
+                [&]<std::size_t... I>(std::index_sequence<I...>) {
+                    ((std::get<I>(columns)[index] = std::move(value.*std::get<I>(SoaLayout<T>::members))), ...);
+                }(Indices());
+            }
+
+            void swap(std::size_t a, std::size_t b) {
+                std::apply([a, b](auto&... column) { (std::swap(column[a], column[b]), ...); }, columns);
+            }
+        private:
+            template<typename Tuple>
+            struct ColumnsOf {};
+
+            template<typename... M>
+            struct ColumnsOf<std::tuple<M...>> {
+                static_assert(!(std::is_array_v<typename MemberPointer<M>::type> || ...), "Cannot split component. Array members must be std::array.");
+                using type = std::tuple<std::pmr::vector<typename MemberPointer<M>::type>...>;
+            };
+
+            using Columns = typename ColumnsOf<Members>::type;
+            Columns columns;
+
+            template<std::size_t... I>
+            static Columns make_columns(std::pmr::memory_resource* resource, std::index_sequence<I...>) {
+                return Columns(std::tuple_element_t<I, Columns>(resource)...);
+            }
+
+            template<auto Member>
+            static constexpr std::size_t member_index() {
+                constexpr std::size_t index = []<std::size_t... I>(std::index_sequence<I...>) {
+                    std::size_t found = sizeof...(I);
+                    ((found = is_same_member<std::get<I>(SoaLayout<T>::members), Member>() ? I : found), ...);
+                    return found;
+                }(Indices());
+                static_assert(index < std::tuple_size_v<Members>, "Member isn't listed in the component type's SoaLayout.");
+
+                return index;
+            }
+
+            template<auto A, auto B>
+            static constexpr bool is_same_member() {
+                if constexpr(std::is_same_v<decltype(A), decltype(B)>) {
+                    return A == B;
+                } else {
+                    return false;
+                }
+            }
+    };
+
+    // A run of consecutive split components. column() returns one member of each of them, and indexing returns
+    // proxies. T is const for read only access.
+    template<typename T>
+    class SoaSpan {
+        using Vector = std::conditional_t<std::is_const_v<T>, const SoaVector<std::remove_const_t<T>>, SoaVector<std::remove_const_t<T>>>;
+
+        public:
+            SoaSpan(Vector* vector, std::size_t offset, std::size_t count) : vector(vector), offset(offset), count(count) {}
+
+            template<auto Member>
+            auto column() const {
+                return std::span(vector->template column<Member>()).subspan(offset, count);
+            }
+
+            SoaReference<T> operator[](std::size_t index) const {
+                return SoaReference<T>(vector, offset + index);
+            }
+
+            std::size_t size() const {
+                return count;
+            }
+        private:
+            Vector* vector;
+            std::size_t offset;
+            std::size_t count;
+    };
+
+    // A run of consecutive components, std::span unless T is split into member arrays. T may be const.
+    template<typename T>
+    using ComponentSpan = std::conditional_t<SoaComponent<std::remove_const_t<T>>, SoaSpan<T>, std::span<T>>;
+
+    // Stores components of a single type in a dense array kept parallel to a sparse set of their owners.
+    //
+    // Two more parallel arrays hold the tick at which each component was added and the tick at which it was last
+    // handed out by a non-const accessor, read from the world's tick counter. The const accessors leave the changed
+    // tick alone. An array without a world tick stamps everything with tick 0.
+    //
+    // The array also holds the hooks registered for its component type. It doesn't call the add and remove hooks
+    // itself; the ECS calls notify_added() and notify_removed() once the entity's signature and groups are consistent
+    // with the component being there.
+    template<typename T>
+    class ComponentArray : public IComponentArray {
+        public:
+            using reference = ComponentReference<T>;
+            using const_reference = ComponentReference<const T>;
+
+            ComponentArray(const std::atomic<Tick>* world_tick = nullptr, std::pmr::memory_resource* resource = std::pmr::get_default_resource()) :
+                entity_set(resource),
+                values(resource),
+                added_ticks(resource),
+                changed_ticks(resource),
+                world_tick(world_tick),
+                add_hooks(resource),
+                replace_hooks(resource),
+                remove_hooks(resource) {}
+
+            // Constructs the component in place at the back of the dense array and returns it
+            template<typename... Args>
+            reference emplace_component(Entity entity, Args&&... args) {
+                ecs_assert(!has_component(entity), "Cannot insert component. Entity already has component of this type.");
+
+                Tick tick = current_tick();
+                entity_set.insert(entity);
+                values.emplace_back(std::forward<Args>(args)...);
+                added_ticks.push_back(tick);
+                changed_ticks.push_back(tick);
+
+                return values.back();
+            }
+
+            void insert_component(Entity entity, T component) {
+                emplace_component(entity, std::move(component));
+            }
+
+            // Appends the components to the dense arrays in one go
+            void insert_components(std::span<const Entity> entities, std::span<const T> components) {
+                ecs_assert(entities.size() == components.size(), "Cannot insert components. There must be one component per entity.");
+                ecs_assert(std::none_of(entities.begin(), entities.end(), [this](Entity entity) { return has_component(entity); }), "Cannot insert components. Entity already has component of this type.");
+
+                Tick tick = current_tick();
+                entity_set.insert(entities);
+                if constexpr(SoaComponent<T>) {
+                    values.reserve(values.size() + components.size());
+                    for(const T& component : components) {
+                        values.push_back(component);
+                    }
+                } else {
+                    values.insert(values.end(), components.begin(), components.end());
+                }
+                added_ticks.resize(values.size(), tick);
+                changed_ticks.resize(values.size(), tick);
+            }
+
+            void remove_component(Entity entity) {
+                ecs_assert(has_component(entity), "Cannot remove component. Entity doesn't have a component of this type.");
+
+                // Move the last component into the removed component's slot, to ensure data remains tightly packed in the array
+                std::uint32_t index_of_removed_entity = entity_set.remove(entity);
+                if(index_of_removed_entity != values.size() - 1) {
+                    values[index_of_removed_entity] = std::move(values.back());
+                }
+                values.pop_back();
+                added_ticks[index_of_removed_entity] = added_ticks.back();
+                added_ticks.pop_back();
+                changed_ticks[index_of_removed_entity] = changed_ticks.back();
+                changed_ticks.pop_back();
+                removed_tick = current_tick();
+            }
+
+            // Overwrites the entity's component and calls the replace hooks with the previous and the new value
+            void replace_component(Entity entity, T component) {
+                reference current = get_component(entity);
+                if(replace_hooks.empty()) {
+                    current = std::move(component);
+                    return;
+                }
+
+                T previous = std::move(current);
+                current = std::move(component);
+                for(auto const& hook : replace_hooks) {
+                    hook(entity, previous, current);
+                }
+            }
+
+            reference get_component(Entity entity) {
+                ecs_assert(has_component(entity), "Cannot get component data. Entity doesn't have a component of this type.");
+
+                return value_at(entity_set.index_of(entity));
+            }
+
+            const_reference get_component(Entity entity) const {
+                ecs_assert(has_component(entity), "Cannot get component data. Entity doesn't have a component of this type.");
+
+                return values[entity_set.index_of(entity)];
+            }
+
+            bool has_component(Entity entity) const {
+                return entity_set.contains(entity);
+            }
+
+            // Returns the position of the entity's component in the dense array
+            std::size_t index_of(Entity entity) const override {
+                ecs_assert(has_component(entity), "Cannot get component index. Entity doesn't have a component of this type.");
+
+                return entity_set.index_of(entity);
+            }
+
+            // Returns the component at the given position in the dense array
+            reference value_at(std::size_t index) {
+                changed_ticks[index] = current_tick();
+                return values[index];
+            }
+
+            const_reference value_at(std::size_t index) const {
+                return values[index];
+            }
+
+            // Returns one member of every component, parallel to entities(), for component types with a SoaLayout. A
+            // loop over a column touches only that member and can be vectorized. The mutable column marks every
+            // component as changed.
+            //     for(Vec2& position : particles.column<&Particle::position>()) { ... }
+            template<auto Member>
+            std::span<member_type<Member>> column() requires SoaComponent<T> {
+                std::fill(changed_ticks.begin(), changed_ticks.end(), current_tick());
+                return values.template column<Member>();
+            }
+
+            template<auto Member>
+            std::span<const member_type<Member>> column() const requires SoaComponent<T> {
+                return values.template column<Member>();
+            }
+
+            // Returns count components starting at the given position in the dense array. The mutable chunk marks
+            // them as changed.
+            ComponentSpan<T> chunk(std::size_t offset, std::size_t count) {
+                std::fill(changed_ticks.begin() + offset, changed_ticks.begin() + offset + count, current_tick());
+                if constexpr(SoaComponent<T>) {
+                    return SoaSpan<T>(&values, offset, count);
+                } else {
+                    return std::span<T>(values.data() + offset, count);
+                }
+            }
+
+            ComponentSpan<const T> chunk(std::size_t offset, std::size_t count) const {
+                if constexpr(SoaComponent<T>) {
+                    return SoaSpan<const T>(&values, offset, count);
+                } else {
+                    return std::span<const T>(values.data() + offset, count);
+                }
+            }
+
+            // The owners of the components, and the ticks at which they were added and last changed, all parallel to
+            // the dense array of components
+            const std::pmr::vector<Entity>& entities() const {
+                return entity_set.entities();
+            }
+
+            const std::pmr::vector<Tick>& get_added_ticks() const {
+                return added_ticks;
+            }
+
+            const std::pmr::vector<Tick>& get_changed_ticks() const {
+                return changed_ticks;
+            }
+
+            void swap_dense(std::size_t a, std::size_t b) override {
+                if(a == b) {
+                    return;
+                }
+                entity_set.swap((std::uint32_t)a, (std::uint32_t)b);
+                using std::swap;
+                swap(values[a], values[b]);
+                std::swap(added_ticks[a], added_ticks[b]);
+                std::swap(changed_ticks[a], changed_ticks[b]);
+            }
+
+            std::size_t size() const override {
+                return entity_set.size();
+            }
+
+            void destroy(std::pmr::memory_resource* resource) override {
+                std::pmr::polymorphic_allocator<ComponentArray>(resource).delete_object(this);
+            }
+
+            // Trivially copyable components are saved as their raw bytes. Components of any other type need a
+            // serializer, which writes a component to the snapshot, and a deserializer, which reads one back in the
+            // same format. A serializer set for a trivially copyable type is used instead of the raw bytes.
+            void set_serializer(std::function<void(SnapshotWriter&, const T&)> serializer, std::function<T(SnapshotReader&)> deserializer) {
+                this->serializer = std::move(serializer);
+                this->deserializer = std::move(deserializer);
+            }
+
+            void save(SnapshotWriter& writer) const override {
+                ecs_assert(serializer || std::is_trivially_copyable_v<T>, "Cannot save snapshot. Component type " + std::string(typeid(T).name()) + " isn't trivially copyable and has no serializer.");
+
+                SnapshotComponentHeader header = (SnapshotComponentHeader) {
+                    .hash = type_hash<T>(),
+                    .value_bytes = 0,
+                    .count = (std::uint32_t)size(),
+                    .value_size = serializer ? 0 : (std::uint32_t)sizeof(T)
+                };
+                writer.write_section(&header, sizeof(header));
+                std::size_t header_offset = writer.size() - sizeof(header);
+
+                writer.write_section(entities().data(), header.count * sizeof(Entity));
+                writer.write_section(added_ticks.data(), header.count * sizeof(Tick));
+                writer.write_section(changed_ticks.data(), header.count * sizeof(Tick));
+
+                writer.write_section(nullptr, 0);
+                std::size_t values_offset = writer.size();
+                if(serializer) {
+                    for(std::size_t position = 0; position < values.size(); position++) {
+                        serializer(writer, values[position]);
+                    }
+                } else if constexpr(std::is_trivially_copyable_v<T>) {
+                    if constexpr(SoaComponent<T>) {
+                        // Split components are gathered back into whole ones, so the snapshot doesn't depend on the layout
+                        std::span<std::byte> value_bytes = writer.reserve_section(values.size() * sizeof(T));
+                        for(std::size_t position = 0; position < values.size(); position++) {
+                            T value = values.load(position);
+                            std::memcpy(value_bytes.data() + position * sizeof(T), &value, sizeof(T));
+                        }
+                    } else {
+                        writer.write(values.data(), values.size() * sizeof(T));
+                    }
+                }
+
+                // The size of the values is only known once they are written
+                header.value_bytes = writer.size() - values_offset;
+                writer.overwrite(header_offset, header);
+            }
+
+            // Raw components are copied out of the snapshot with a single bulk copy per array, and the sparse set is
+            // rebuilt in one pass over the loaded entities
+            void load(SnapshotReader& reader, const SnapshotComponentHeader& header) override {
+                std::span<const Entity> loaded_entities = reader.section<Entity>(header.count);
+                std::span<const Tick> loaded_added_ticks = reader.section<Tick>(header.count);
+                std::span<const Tick> loaded_changed_ticks = reader.section<Tick>(header.count);
+
+                clear();
+                entity_set.insert(loaded_entities);
+                added_ticks.assign(loaded_added_ticks.begin(), loaded_added_ticks.end());
+                changed_ticks.assign(loaded_changed_ticks.begin(), loaded_changed_ticks.end());
+
+                if(header.value_size == 0) {
+                    ecs_assert(deserializer, "Cannot load snapshot. Component type " + std::string(typeid(T).name()) + " has no deserializer.");
+
+                    SnapshotReader value_reader(reader.section<std::byte>(header.value_bytes));
+                    values.reserve(header.count);
+                    for(std::uint32_t i = 0; i < header.count; i++) {
+                        values.push_back(deserializer(value_reader));
+                    }
+                } else if constexpr(std::is_trivially_copyable_v<T>) {
+                    ecs_assert(header.value_size == sizeof(T), "Cannot load snapshot. Component type " + std::string(typeid(T).name()) + " has changed size.");
+
+                    std::span<const T> loaded_values = reader.section<T>(header.count);
+                    values.assign(loaded_values.begin(), loaded_values.end());
+                } else {
+                    ecs_assert(false, "Cannot load snapshot. Component type " + std::string(typeid(T).name()) + " isn't trivially copyable and was saved as raw bytes.");
+                    reader.section<std::byte>(header.value_bytes);
+                }
+            }
+
+            // Raw values are read in place, so they have to be aligned for T
+            bool accepts(std::uint32_t value_size, const std::byte* values) const override {
+                if(value_size == 0) {
+                    return (bool)deserializer;
+                }
+
+                return std::is_trivially_copyable_v<T> && value_size == sizeof(T) && reinterpret_cast<std::uintptr_t>(values) % alignof(T) == 0;
+            }
+
+            // Only components added or handed out mutably since the baseline's tick are compared with the baseline.
+            // The baseline is only searched for removed components if the array has removed any since then.
+            bool save_delta(SnapshotWriter& writer, const SnapshotView& baseline, const std::function<bool(Entity)>& is_alive) const override {
+                // A component which hasn't changed since the baseline's tick was already there, unchanged, when the
+                // baseline was saved
+                std::vector<std::uint32_t> changed_positions;
+                for(std::uint32_t position = 0; position < changed_ticks.size(); position++) {
+                    if(changed_ticks[position] >= baseline.get_tick()) {
+                        changed_positions.push_back(position);
+                    }
+                }
+                bool removed_since_baseline = removed_tick >= baseline.get_tick();
+                if(changed_positions.empty() && !removed_since_baseline) {
+                    return false;
+                }
+
+                std::span<const Entity> baseline_entities;
+                if(baseline.has<T>()) {
+                    baseline_entities = baseline.entities<T>();
+                }
+                std::span<const T> baseline_values;
+                if constexpr(std::is_trivially_copyable_v<T>) {
+                    if(!serializer && !baseline_entities.empty()) {
+                        baseline_values = baseline.components<T>();
+                    }
+                }
+
+                // Maps entity slots to positions in the baseline's dense array
+                static constexpr std::uint32_t NOT_IN_BASELINE = std::numeric_limits<std::uint32_t>::max();
+                std::vector<std::uint32_t> baseline_positions(baseline_entities.empty() ? 0 : baseline.get_generations().size(), NOT_IN_BASELINE);
+                std::vector<Entity> removed_entities;
+                for(std::uint32_t position = 0; position < baseline_entities.size(); position++) {
+                    Entity entity = baseline_entities[position];
+                    baseline_positions[entity_index(entity)] = position;
+
+                    // Components of removed entities go with them
+                    if(removed_since_baseline && !has_component(entity) && is_alive(entity)) {
+                        removed_entities.push_back(entity);
+                    }
+                }
+
+                // Candidates which are in the baseline under the same entity and have the same bytes there were only
+                // handed out mutably
+                const std::pmr::vector<Entity>& dense_entities = entities();
+                std::erase_if(changed_positions, [&](std::uint32_t position) {
+                    Entity entity = dense_entities[position];
+                    std::uint32_t index = entity_index(entity);
+                    std::uint32_t baseline_position = index < baseline_positions.size() ? baseline_positions[index] : NOT_IN_BASELINE;
+                    if(baseline_position == NOT_IN_BASELINE || baseline_entities[baseline_position] != entity) {
+                        return false;
+                    }
+
+                    if constexpr(std::is_trivially_copyable_v<T>) {
+                        const T& value = values[position];
+                        return !baseline_values.empty() && std::memcmp(&value, &baseline_values[baseline_position], sizeof(T)) == 0;
+                    } else {
+                        return false;
+                    }
+                });
+
+                if(removed_entities.empty() && changed_positions.empty()) {
+                    return false;
+                }
+
+                ecs_assert(serializer || std::is_trivially_copyable_v<T>, "Cannot save delta. Component type " + std::string(typeid(T).name()) + " isn't trivially copyable and has no serializer.");
+
+                DeltaComponentHeader header = (DeltaComponentHeader) {
+                    .hash = type_hash<T>(),
+                    .value_bytes = 0,
+                    .removed_count = (std::uint32_t)removed_entities.size(),
+                    .changed_count = (std::uint32_t)changed_positions.size(),
+                    .value_size = serializer ? 0 : (std::uint32_t)sizeof(T),
+                    .reserved = 0
+                };
+                writer.write_section(&header, sizeof(header));
+                std::size_t header_offset = writer.size() - sizeof(header);
+
+                writer.write_section(removed_entities.data(), removed_entities.size() * sizeof(Entity));
+                writer.write_section(nullptr, 0);
+                for(std::uint32_t position : changed_positions) {
+                    writer.write(dense_entities[position]);
+                }
+
+                writer.write_section(nullptr, 0);
+                std::size_t values_offset = writer.size();
+                for(std::uint32_t position : changed_positions) {
+                    if(serializer) {
+                        serializer(writer, values[position]);
+                    } else if constexpr(std::is_trivially_copyable_v<T>) {
+                        writer.write<T>(values[position]);
+                    }
+                }
+
+                header.value_bytes = writer.size() - values_offset;
+                writer.overwrite(header_offset, header);
+
+                return true;
+            }
+
+            // Components the entity already has are replaced, which calls the replace hooks and marks them changed
+            void apply_delta(SnapshotReader& reader, const DeltaComponentHeader& header, std::vector<Entity>& added) override {
+                std::span<const Entity> changed_entities = reader.section<Entity>(header.changed_count);
+                std::span<const std::byte> value_bytes = reader.section<std::byte>(header.value_bytes);
+                SnapshotReader value_reader(value_bytes);
+
+                for(Entity entity : changed_entities) {
+                    T value = read_delta_value(value_reader, header);
+                    if(has_component(entity)) {
+                        replace_component(entity, std::move(value));
+                    } else {
+                        emplace_component(entity, std::move(value));
+                        added.push_back(entity);
+                    }
+                }
+            }
+
+            // Removes every component without calling the remove hooks
+            void clear() override {
+                entity_set.clear();
+                values.clear();
+                added_ticks.clear();
+                changed_ticks.clear();
+                removed_tick = current_tick();
+            }
+
+            void handle_entity_removed(Entity entity) override {
+                if(has_component(entity)) {
+                    remove_component(entity);
+                }
+            }
+
+            void on_add(std::function<void(Entity, reference)> hook) {
+                add_hooks.push_back(std::move(hook));
+            }
+
+            void on_replace(std::function<void(Entity, const T&, reference)> hook) {
+                replace_hooks.push_back(std::move(hook));
+            }
+
+            void on_remove(std::function<void(Entity, reference)> hook) {
+                remove_hooks.push_back(std::move(hook));
+            }
+
+            void notify_added(Entity entity) override {
+                for(auto const& hook : add_hooks) {
+                    hook(entity, values[entity_set.index_of(entity)]);
+                }
+            }
+
+            void notify_removed(Entity entity) override {
+                for(auto const& hook : remove_hooks) {
+                    hook(entity, values[entity_set.index_of(entity)]);
+                }
+            }
+        private:
+            SparseSet entity_set;
+            std::conditional_t<SoaComponent<T>, SoaVector<T>, std::pmr::vector<T>> values;
+            std::pmr::vector<Tick> added_ticks;
+            std::pmr::vector<Tick> changed_ticks;
+            const std::atomic<Tick>* world_tick;
+
+            // The tick of the last removal, which lets deltas skip looking for removed components
+            Tick removed_tick = 0;
+
+            std::pmr::vector<std::function<void(Entity, reference)>> add_hooks;
+            std::pmr::vector<std::function<void(Entity, const T&, reference)>> replace_hooks;
+            std::pmr::vector<std::function<void(Entity, reference)>> remove_hooks;
+
+            std::function<void(SnapshotWriter&, const T&)> serializer;
+            std::function<T(SnapshotReader&)> deserializer;
+
+            Tick current_tick() const {
+                return world_tick ? world_tick->load(std::memory_order_relaxed) : 0;
+            }
+
+            T read_delta_value(SnapshotReader& reader, const DeltaComponentHeader& header) {
+                if(header.value_size == 0) {
+                    ecs_assert(deserializer, "Cannot apply delta. Component type " + std::string(typeid(T).name()) + " has no deserializer.");
+                    return deserializer(reader);
+                }
+
+                if constexpr(std::is_trivially_copyable_v<T>) {
+                    ecs_assert(header.value_size == sizeof(T), "Cannot apply delta. Component type " + std::string(typeid(T).name()) + " has changed size.");
+                    return reader.read<T>();
+                } else {
+                    ecs_assert(false, "Cannot apply delta. Component type " + std::string(typeid(T).name()) + " isn't trivially copyable and was saved as raw bytes.");
+                    return deserializer(reader);
+                }
+            }
+    };
+
+    // The name systems use for a component array they hold on to, see ECS::storage()
+    template<typename T>
+    using ComponentStorage = ComponentArray<T>;
+
+    // The set of living entities whose signature contains the group's signature and none of its excluded component
+    // types. The ECS creates a group the first time a view asks for its signatures and keeps it up to date as entity
+    // signatures change, so views never have to scan the world.
+    //
+    // A group can also be packed, in which case it owns the component arrays of its component types. The group then
+    // keeps its members at the front of each of those arrays, in the same order as the group itself, so the entity at
+    // position i of the group has its components at position i of every array. Iterating a packed group is a linear
+    // sweep over parallel arrays, the same layout an archetype table would give.
+    class Group {
+        public:
+            Group(const Signature& signature, const Signature& excluded, std::pmr::memory_resource* resource = std::pmr::get_default_resource()) :
+                signature(signature),
+                excluded(excluded),
+                entity_set(resource),
+                packed_arrays(resource) {}
+
+            bool matches(const Signature& entity_signature) const {
+                return entity_signature.contains(signature) && !entity_signature.intersects(excluded);
+            }
+
+            const Signature& get_signature() const {
+                return signature;
+            }
+
+            const Signature& get_excluded() const {
+                return excluded;
+            }
+
+            SparseSet& get_entity_set() {
+                return entity_set;
+            }
+
+            bool contains(Entity entity) const {
+                return entity_set.contains(entity);
+            }
+
+            bool is_packed() const {
+                return !packed_arrays.empty();
+            }
+
+            // Removes every member, leaving the packed arrays as they are
+            void clear() {
+                entity_set.clear();
+            }
+
+            // Takes ownership of the order of the component arrays and moves the current members to the front of them
+            void pack(const std::vector<IComponentArray*>& component_arrays) {
+                packed_arrays.assign(component_arrays.begin(), component_arrays.end());
+
+                const std::pmr::vector<Entity>& entities = entity_set.entities();
+                for(std::size_t i = 0; i < entities.size(); i++) {
+                    for(IComponentArray* component_array : packed_arrays) {
+                        component_array->swap_dense(component_array->index_of(entities[i]), i);
+                    }
+                }
+            }
+
+            // The entity's components must already be in the packed arrays
+            void insert(Entity entity) {
+                std::uint32_t index = entity_set.insert(entity);
+
+                for(IComponentArray* component_array : packed_arrays) {
+                    component_array->swap_dense(component_array->index_of(entity), index);
+                }
+            }
+
+            // The entity's components must still be in the packed arrays
+            void remove(Entity entity) {
+                std::size_t index = entity_set.index_of(entity);
+                std::size_t last_index = entity_set.size() - 1;
+
+                // Mirror the swap-and-pop the entity set is about to do, leaving the entity's components just past
+                // the end of the group
+                for(IComponentArray* component_array : packed_arrays) {
+                    component_array->swap_dense(index, last_index);
+                }
+                entity_set.remove(entity);
+            }
+        private:
+            Signature signature;
+            Signature excluded;
+            SparseSet entity_set;
+            std::pmr::vector<IComponentArray*> packed_arrays;
+    };
+
+    // A fixed set of worker threads. Each worker owns a deque of tasks; it pushes and pops tasks at the back of its
+    // own deque, and when that runs dry it steals from the front of the other workers' deques.
+    class ThreadPool {
+        public:
+            ThreadPool(std::size_t thread_count = std::thread::hardware_concurrency()) {
+                thread_count = std::max<std::size_t>(thread_count, 1);
+                stopping = false;
+                queued_tasks = 0;
+                next_worker = 0;
+
+                for(std::size_t i = 0; i < thread_count; i++) {
+                    workers.push_back(std::make_unique<Worker>());
+                }
+                for(std::size_t i = 0; i < thread_count; i++) {
+                    threads.emplace_back([this, i]() {
+                        worker_loop(i);
+                    });
+                }
+            }
+
+            ~ThreadPool() {
+                {
+                    std::lock_guard<std::mutex> lock(sleep_mutex);
+                    stopping = true;
+                }
+                wake.notify_all();
+
+                for(std::thread& thread : threads) {
+                    thread.join();
+                }
+            }
+
+            ThreadPool(const ThreadPool&) = delete;
+            ThreadPool& operator=(const ThreadPool&) = delete;
+
+            std::size_t size() const {
+                return workers.size();
+            }
+
+            // Queues the task. Tasks submitted from one of the pool's workers go to that worker's own deque, others
+            // are dealt out to the workers in turn.
+            void submit(std::function<void()> task) {
+                std::size_t worker_index = current_pool == this ? current_worker : next_worker++ % workers.size();
+                {
+                    std::lock_guard<std::mutex> lock(sleep_mutex);
+                    queued_tasks++;
+                }
+                {
+                    std::lock_guard<std::mutex> lock(workers[worker_index]->mutex);
+                    workers[worker_index]->tasks.push_back(std::move(task));
+                }
+                wake.notify_one();
+            }
+
+            // Blocks until the counter reaches zero. Instead of sleeping, the calling thread runs queued tasks while
+            // it waits, so waiting from inside a task can't deadlock the pool.
+            void wait(const std::atomic<std::size_t>& pending) {
+                std::size_t preferred_worker = current_pool == this ? current_worker : 0;
+
+                while(pending.load(std::memory_order_acquire) > 0) {
+                    if(!run_one_task(preferred_worker)) {
+                        std::this_thread::yield();
+                    }
+                }
+            }
+        private:
+            struct Worker {
+                std::deque<std::function<void()>> tasks;
+                std::mutex mutex;
+            };
+
+            std::vector<std::unique_ptr<Worker>> workers;
+            std::vector<std::thread> threads;
+
+            std::mutex sleep_mutex;
+            std::condition_variable wake;
+            bool stopping;
+            std::size_t queued_tasks;
+            std::atomic<std::size_t> next_worker;
+
+            static inline thread_local ThreadPool* current_pool = nullptr;
+            static inline thread_local std::size_t current_worker = 0;
+
+            // Pops a task from the back of the preferred worker's deque, or steals one from the front of another's
+            bool take_task(std::size_t preferred_worker, std::function<void()>& task) {
+                for(std::size_t offset = 0; offset < workers.size(); offset++) {
+                    std::size_t worker_index = (preferred_worker + offset) % workers.size();
+                    Worker& worker = *workers[worker_index];
+
+                    std::lock_guard<std::mutex> lock(worker.mutex);
+                    if(worker.tasks.empty()) {
+                        continue;
+                    }
+                    if(offset == 0) {
+                        task = std::move(worker.tasks.back());
+                        worker.tasks.pop_back();
+                    } else {
+                        task = std::move(worker.tasks.front());
+                        worker.tasks.pop_front();
+                    }
+                    return true;
+                }
+
+                return false;
+            }
+
+            bool run_one_task(std::size_t preferred_worker) {
+                std::function<void()> task;
+                if(!take_task(preferred_worker, task)) {
+                    return false;
+                }
+                {
+                    std::lock_guard<std::mutex> lock(sleep_mutex);
+                    queued_tasks--;
+                }
+
+                task();
+                return true;
+            }
+
+            void worker_loop(std::size_t worker_index) {
+                current_pool = this;
+                current_worker = worker_index;
+
+                while(true) {
+                    if(run_one_task(worker_index)) {
+                        continue;
+                    }
+
+                    std::unique_lock<std::mutex> lock(sleep_mutex);
+                    wake.wait(lock, [this]() {
+                        return stopping || queued_tasks > 0;
+                    });
+                    if(stopping) {
+                        return;
+                    }
+                }
+            }
+    };
+
+    // The component types the scheduled system running on this thread declared as written, or null outside of one.
+    // Mutable access stamps a component's change tick, so in debug builds the ECS checks that a scheduled system only
+    // asks for mutable access to the types it writes. Systems which only read a type may run at the same time.
+    inline thread_local const Signature* scheduled_writes = nullptr;
+
+    class ECS;
+
+    // Marks a view component type as optional. The view doesn't require its entities to have the component, and
+    // each() passes a pointer to it which is null for entities without one.
+    //     ecs.view<Position, ecs::Optional<Velocity>>().each([](Position& position, Velocity* velocity) { ... });
+    template<typename T>
+    struct Optional {};
+
+    // Lists the component types a view leaves out, for ECS::view()
+    //     ecs.view<Position>(ecs::exclude<Velocity>).each([](Position& position) { ... });
+    template<typename... Excluded>
+    struct Exclude {};
+
+    template<typename... Excluded>
+    inline constexpr Exclude<Excluded...> exclude{};
+
+    // Maps a view component type to the component it stores and the argument each() passes for it. Views access const
+    // component types through the const accessors of their arrays, which don't mark the components as changed.
+    template<typename T>
+    struct ViewComponent {
+        using type = std::remove_const_t<T>;
+        using access = T;
+        using argument = ComponentReference<T>;
+        using chunk = ComponentSpan<T>;
+        static const bool optional = false;
+    };
+
+    // Split components have no address, so optional ones are passed as an optional proxy instead of a pointer
+    template<typename T>
+    struct ViewComponent<Optional<T>> {
+        using type = std::remove_const_t<T>;
+        using access = T;
+        using argument = std::conditional_t<SoaComponent<type>, std::optional<SoaReference<T>>, T*>;
+        using chunk = void;
+        static const bool optional = true;
+    };
+
+    // Narrows a view to the entities whose component of one type was added or changed after a given tick. The view
+    // then walks that component's array instead of the group, checking each component's tick first and group membership
+    // second, so the entities which didn't change cost one tick compare each. When every owner of the component is in
+    // the group, group is left null and membership isn't checked. The filtered component itself is read by position.
+    struct TickFilter {
+        const IComponentArray* component_array = nullptr;
+        const std::pmr::vector<Entity>* entities = nullptr;
+        const std::pmr::vector<Tick>* ticks = nullptr;
+        Tick since = 0;
+        bool required = false;
+        const Group* group = nullptr;
+
+        bool passes(std::size_t position) const {
+            return (*ticks)[position] > since && (!group || group->contains((*entities)[position]));
+        }
+    };
+
+    // A lightweight handle to a group's entities. Copying a view doesn't copy the entities, and the view always
+    // reflects the group's current members.
+    //
+    // Views iterate from the back of the group to the front. Removing the entity currently being visited (or one of
+    // its components) swaps an already visited entity into its place, so doing so doesn't skip or repeat anyone.
+    // Removing any other member of the view during iteration is not supported.
+    //
+    // The view holds pointers to the component arrays of its component types, so each() and get() hand out typed
+    // components without looking up the component type for every entity.
+    template<typename... Components>
+    class View {
+        public:
+            class Iterator {
+                public:
+                    Iterator(const TickFilter& filter, const std::pmr::vector<Entity>* entities, std::size_t position) : filter(filter), entities(entities), position(position) {
+                        skip_filtered();
+                    }
+
+                    Entity operator*() const {
+                        return (*entities)[position - 1];
+                    }
+
+                    Iterator& operator++() {
+                        position--;
+                        skip_filtered();
+                        return *this;
+                    }
+
+                    bool operator==(const Iterator& other) const {
+                        return position == other.position;
+                    }
+
+                    bool operator!=(const Iterator& other) const {
+                        return position != other.position;
+                    }
+                private:
+                    TickFilter filter;
+                    const std::pmr::vector<Entity>* entities;
+                    std::size_t position;
+
+                    void skip_filtered() {
+                        while(filter.ticks && position > 0 && !filter.passes(position - 1)) {
+                            position--;
+                        }
+                    }
+            };
+
+            View(ECS* world, Group* group, ComponentArray<typename ViewComponent<Components>::type>*... component_arrays) : world(world), group(group), component_arrays(component_arrays...) {}
+
+            Iterator begin() const {
+                return Iterator(active_filter(), &iterated_entities(), iterated_entities().size());
+            }
+
+            Iterator end() const {
+                return Iterator(active_filter(), &iterated_entities(), 0);
+            }
+
+            // With an added() or changed() filter, counts the entities which pass it
+            std::size_t size() const {
+                if(!filter.ticks) {
+                    return group->get_entity_set().size();
+                }
+
+                TickFilter active = active_filter();
+                std::size_t count = 0;
+                for(std::size_t position = 0; position < active.entities->size(); position++) {
+                    count += active.passes(position);
+                }
+
+                return count;
+            }
+
+            bool empty() const {
+                return begin() == end();
+            }
+
+            // Returns the entity's component of type T, where T is one of the view's component types. The entity must
+            // have the component even if T is optional in this view.
+            template<typename T>
+            ComponentReference<T> get(Entity entity) const {
+                ComponentArray<std::remove_const_t<T>>& component_array = *std::get<ComponentArray<std::remove_const_t<T>>*>(component_arrays);
+                if constexpr(std::is_const_v<T>) {
+                    return std::as_const(component_array).get_component(entity);
+                } else {
+                    return component_array.get_component(entity);
+                }
+            }
+
+            // Returns a view of the same component types which leaves out entities that have any of the excluded
+            // component types. Excluded entities are filtered out when the view's group is built and as signatures
+            // change, so they never reach each(). This view's group has already been built and is kept up to date, so
+            // starting from the world, ECS::view() with ecs::exclude is cheaper.
+            template<typename... Excluded>
+            View without() const;
+
+            // Returns a view of the entities whose component of type T was added after the given tick. T must be one of
+            // the view's component types.
+            template<typename T>
+            View added(Tick since) const {
+                const ComponentArray<std::remove_const_t<T>>* component_array = std::get<ComponentArray<std::remove_const_t<T>>*>(component_arrays);
+                return filtered<T>(component_array->entities(), component_array->get_added_ticks(), since);
+            }
+
+            // Returns a view of the entities whose component of type T was added or accessed mutably after the given
+            // tick. T must be one of the view's component types.
+            template<typename T>
+            View changed(Tick since) const {
+                const ComponentArray<std::remove_const_t<T>>* component_array = std::get<ComponentArray<std::remove_const_t<T>>*>(component_arrays);
+                return filtered<T>(component_array->entities(), component_array->get_changed_ticks(), since);
+            }
+
+            // Calls the function once per entity in the view with references to the entity's components, in the
+            // order the component types were given to the view. The function may take the entity as its first
+            // argument or leave it out.
+            //     view.each([](ecs::Entity entity, Position& position, Velocity& velocity) { ... });
+            //     view.each([](Position& position, Velocity& velocity) { ... });
+            template<typename Function>
+            void each(Function function) const {
+                const std::pmr::vector<Entity>& entities = iterated_entities();
+
+                if(filter.ticks) {
+                    TickFilter active = active_filter();
+                    for(std::size_t position = entities.size(); position > 0; position--) {
+                        if(active.passes(position - 1)) {
+                            invoke_filtered(function, entities[position - 1], position - 1);
+                        }
+                    }
+                } else if(group->is_packed()) {
+                    for(std::size_t position = entities.size(); position > 0; position--) {
+                        invoke_packed(function, entities, position - 1);
+                    }
+                } else {
+                    for(std::size_t position = entities.size(); position > 0; position--) {
+                        invoke(function, entities[position - 1]);
+                    }
+                }
+            }
+
+            // Calls the function once per chunk of the view's entities, with a span of the chunk's entities and a span
+            // per component type over their components, in the order the component types were given to the view.
+            // Split component types come as SoaSpans instead. The function may leave out the entities. Only a packed
+            // view keeps its components at the same positions in every array (see ECS::pack()), so only packed views
+            // can be iterated in chunks, and they can't have optional component types or a tick filter. A loop over
+            // the spans needs no lookups and can be vectorized. Mutable spans mark the chunk's components as changed.
+            //     view.each_chunk([](std::span<Position> positions, std::span<const Velocity> velocities) { ... });
+            template<typename Function>
+            void each_chunk(Function function, std::size_t chunk_size = PARALLEL_GRAIN_SIZE) const {
+                static_assert(!(ViewComponent<Components>::optional || ...), "Cannot iterate view in chunks. Optional components aren't packed.");
+                ecs_assert(!filter.ticks, "Cannot iterate view in chunks. View is filtered by a tick.");
+                ecs_assert(group->is_packed(), "Cannot iterate view in chunks. View isn't packed.");
+
+                const std::pmr::vector<Entity>& entities = group->get_entity_set().entities();
+                for(std::size_t offset = 0; offset < entities.size(); offset += chunk_size) {
+                    std::size_t count = std::min(chunk_size, entities.size() - offset);
+                    std::span<const Entity> chunk_entities(entities.data() + offset, count);
+                    if constexpr(std::is_invocable_v<Function, std::span<const Entity>, typename ViewComponent<Components>::chunk...>) {
+                        function(chunk_entities, array_of<Components>().chunk(offset, count)...);
+                    } else {
+                        function(array_of<Components>().chunk(offset, count)...);
+                    }
+                }
+            }
+
+            // Like each(), but splits the view into chunks and runs them on the thread pool, returning once every
+            // chunk is done. Chunks hold at least grain_size entities and are rounded to whole cache lines of the
+            // view's entity array. By default the chunks are made larger for big views so that each worker gets a few
+            // of them. With deterministic set, every chunk holds exactly grain_size entities (rounded to cache lines)
+            // no matter how many threads the pool has, so the split is the same on every machine. A filtered view
+            // collects the entities which pass its filter first and splits those.
+            //
+            // The function must only touch the components of the entity it is given, and must not add or remove
+            // entities or components. Under those rules the result is identical to each().
+            template<typename Function>
+            void par_each(ThreadPool& thread_pool, Function function, std::size_t grain_size = PARALLEL_GRAIN_SIZE, bool deterministic = false) const {
+                std::pmr::vector<Entity> filtered_entities;
+                if(filter.ticks) {
+                    TickFilter active = active_filter();
+                    for(std::size_t position = 0; position < active.entities->size(); position++) {
+                        if(active.passes(position)) {
+                            filtered_entities.push_back((*filter.entities)[position]);
+                        }
+                    }
+                }
+
+                const std::pmr::vector<Entity>& entities = filter.ticks ? filtered_entities : group->get_entity_set().entities();
+                bool packed = !filter.ticks && group->is_packed();
+                if(entities.empty()) {
+                    return;
+                }
+
+                const std::size_t ENTITIES_PER_CACHE_LINE = CACHE_LINE_SIZE / sizeof(Entity);
+                std::size_t chunk_size = std::max<std::size_t>(grain_size, 1);
+                if(!deterministic) {
+                    chunk_size = std::max(chunk_size, entities.size() / (thread_pool.size() * 4));
+                }
+                chunk_size = ((chunk_size + ENTITIES_PER_CACHE_LINE - 1) / ENTITIES_PER_CACHE_LINE) * ENTITIES_PER_CACHE_LINE;
+
+                std::size_t chunk_count = (entities.size() + chunk_size - 1) / chunk_size;
+                std::atomic<std::size_t> pending_chunks = chunk_count;
+
+                for(std::size_t chunk = 0; chunk < chunk_count; chunk++) {
+                    thread_pool.submit([this, &function, &entities, &pending_chunks, packed, chunk, chunk_size]() {
+                        std::size_t chunk_end = std::min(entities.size(), (chunk + 1) * chunk_size);
+                        if(packed) {
+                            for(std::size_t i = chunk * chunk_size; i < chunk_end; i++) {
+                                invoke_packed(function, entities, i);
+                            }
+                        } else {
+                            for(std::size_t i = chunk * chunk_size; i < chunk_end; i++) {
+                                invoke(function, entities[i]);
+                            }
+                        }
+                        pending_chunks.fetch_sub(1, std::memory_order_release);
+                    });
+                }
+
+                thread_pool.wait(pending_chunks);
+            }
+        private:
+            ECS* world;
+            Group* group;
+            std::tuple<ComponentArray<typename ViewComponent<Components>::type>*...> component_arrays;
+            TickFilter filter;
+
+            // A filtered view walks the filtered component's array instead of the group
+            const std::pmr::vector<Entity>& iterated_entities() const {
+                return filter.ticks ? *filter.entities : group->get_entity_set().entities();
+            }
+
+            template<typename T>
+            View filtered(const std::pmr::vector<Entity>& entities, const std::pmr::vector<Tick>& ticks, Tick since) const {
+                ecs_assert(!filter.ticks, "Cannot filter view. View is already filtered by a tick.");
+
+                View result = *this;
+                result.filter = (TickFilter) {
+                    .component_array = std::get<ComponentArray<std::remove_const_t<T>>*>(component_arrays),
+                    .entities = &entities,
+                    .ticks = &ticks,
+                    .since = since,
+                    .required = ((std::is_same_v<std::remove_const_t<T>, typename ViewComponent<Components>::type> && !ViewComponent<Components>::optional) || ...),
+                    .group = nullptr
+                };
+                return result;
+            }
+
+            // The group only ever holds owners of its required component types, so when it holds as many entities as
+            // the filtered component's array, it holds all of them
+            TickFilter active_filter() const {
+                TickFilter active = filter;
+                if(!filter.ticks || !filter.required || group->get_entity_set().size() != filter.entities->size()) {
+                    active.group = group;
+                }
+
+                return active;
+            }
+
+            template<typename C>
+            auto& array_of() const {
+                ComponentArray<typename ViewComponent<C>::type>& component_array = *std::get<ComponentArray<typename ViewComponent<C>::type>*>(component_arrays);
+                if constexpr(std::is_const_v<typename ViewComponent<C>::access>) {
+                    return std::as_const(component_array);
+                } else {
+                    return component_array;
+                }
+            }
+
+            template<typename C>
+            typename ViewComponent<C>::argument fetch(Entity entity) const {
+                if constexpr(ViewComponent<C>::optional && SoaComponent<typename ViewComponent<C>::type>) {
+                    return array_of<C>().has_component(entity) ? typename ViewComponent<C>::argument(array_of<C>().get_component(entity)) : std::nullopt;
+                } else if constexpr(ViewComponent<C>::optional) {
+                    return array_of<C>().has_component(entity) ? &array_of<C>().get_component(entity) : nullptr;
+                } else {
+                    return array_of<C>().get_component(entity);
+                }
+            }
+
+            // Only the view's required component types are packed, so optional ones are still looked up
+            template<typename C>
+            typename ViewComponent<C>::argument fetch_packed(Entity entity, std::size_t index) const {
+                if constexpr(ViewComponent<C>::optional) {
+                    return fetch<C>(entity);
+                } else {
+                    return array_of<C>().value_at(index);
+                }
+            }
+
+            template<typename C>
+            typename ViewComponent<C>::argument fetch_filtered(Entity entity, std::size_t position) const {
+                if constexpr(!ViewComponent<C>::optional) {
+                    if(&array_of<C>() == filter.component_array) {
+                        return array_of<C>().value_at(position);
+                    }
+                }
+
+                return fetch<C>(entity);
+            }
+
+            template<typename Function>
+            void invoke(Function& function, Entity entity) const {
+                if constexpr(std::is_invocable_v<Function, Entity, typename ViewComponent<Components>::argument...>) {
+                    function(entity, fetch<Components>(entity)...);
+                } else {
+                    function(fetch<Components>(entity)...);
+                }
+            }
+
+            template<typename Function>
+            void invoke_filtered(Function& function, Entity entity, std::size_t position) const {
+                if constexpr(std::is_invocable_v<Function, Entity, typename ViewComponent<Components>::argument...>) {
+                    function(entity, fetch_filtered<Components>(entity, position)...);
+                } else {
+                    function(fetch_filtered<Components>(entity, position)...);
+                }
+            }
+
+            // In a packed group the components sit at the same position as the entity, so no lookups are needed
+            template<typename Function>
+            void invoke_packed(Function& function, const std::pmr::vector<Entity>& entities, std::size_t index) const {
+                if constexpr(std::is_invocable_v<Function, Entity, typename ViewComponent<Components>::argument...>) {
+                    function(entities[index], fetch_packed<Components>(entities[index], index)...);
+                } else {
+                    function(fetch_packed<Components>(entities[index], index)...);
+                }
+            }
+    };
+
+    class ECS {
+        public:
+            // The capacity hint is the number of entities the world expects to hold. Storage is reserved for that
+            // many entities up front. Without a hint nothing is allocated until the first entity is created, so an
+            // empty world is cheap to create and destroy.
+            //
+            // The entity arrays, component arrays, groups and their sparse sets all allocate from the memory resource.
+            // The resource must outlive the world.
+            ECS(std::size_t capacity_hint = 0, std::pmr::memory_resource* resource = std::pmr::get_default_resource()) :
+                memory_resource(resource),
+                entity_living(resource),
+                entity_generations(resource),
+                entity_signatures(resource),
+                free_indices(resource),
+                type_cache(resource),
+                groups(resource),
+                removal_scratch(resource) {
+                entity_array_count = 0;
+                next_unused_index = 0;
+                component_arrays_count = 0;
+                current_tick = 1;
+
+                entity_living.reserve(capacity_hint);
+                entity_generations.reserve(capacity_hint);
+                entity_signatures.reserve(capacity_hint);
+            }
+
+            ~ECS() {
+                for(ComponentType type = 0; type < component_arrays_count; type++) {
+                    component_arrays[type]->destroy(memory_resource);
+                }
+            }
+
+            // Slots which have never been used are handed out before removed entities' slots, so a slot is reused as
+            // late as possible, which keeps generations from wrapping around quickly
+            Entity create_entity() {
+                std::uint32_t index;
+                if(next_unused_index < entity_living.size()) {
+                    index = next_unused_index++;
+                } else if(!free_indices.empty()) {
+                    index = free_indices.front();
+                    free_indices.pop_front();
+                } else {
+                    grow_entity_arrays(entity_living.size() + 1);
+                    index = next_unused_index++;
+                }
+
+                entity_living[index] = true;
+                entity_array_count++;
+                return make_entity(index, entity_generations[index]);
+            }
+
+            // Creates count entities. Removed entities' slots are reused first, so spawning and removing a batch over
+            // and over doesn't grow the world. The rest come from slots which have never been used, with consecutive
+            // indices, so the entity arrays grow at most once and their sparse set slots sit next to each other.
+            std::vector<Entity> create_entities(std::size_t count) {
+                std::vector<Entity> entities;
+                entities.reserve(count);
+
+                std::size_t reused_count = std::min(count, free_indices.size());
+                for(std::size_t i = 0; i < reused_count; i++) {
+                    std::uint32_t index = free_indices.front();
+                    free_indices.pop_front();
+                    entity_living[index] = true;
+                    entities.push_back(make_entity(index, entity_generations[index]));
+                }
+
+                std::size_t unused_count = count - reused_count;
+                if(next_unused_index + unused_count > entity_living.size()) {
+                    grow_entity_arrays(next_unused_index + unused_count);
+                }
+                for(std::uint32_t index = next_unused_index; index < next_unused_index + unused_count; index++) {
+                    entity_living[index] = true;
+                    entities.push_back(make_entity(index, entity_generations[index]));
+                }
+                next_unused_index += (std::uint32_t)unused_count;
+                entity_array_count += (Entity)count;
+
+                return entities;
+            }
+
+            // Removing an entity which is no longer alive does nothing, so a handle that was already removed (for
+            // example by two command buffers) can't retire the slot twice
+            void remove_entity(Entity entity_to_remove) {
+                if(!is_alive(entity_to_remove)) {
+                    return;
+                }
+
+                std::uint32_t index = entity_index(entity_to_remove);
+                Signature signature = entity_signatures[index];
+
+                // Remove hooks see the entity while it is still whole
+                for(ComponentType type = 0; type < component_arrays_count; type++) {
+                    if(signature.test(type)) {
+                        component_arrays[type]->notify_removed(entity_to_remove);
+                    }
+                }
+
+                entity_living[index] = false;
+                entity_signatures[index].reset();
+
+                for(Group& group : groups) {
+                    if(group.contains(entity_to_remove)) {
+                        group.remove(entity_to_remove);
+                    }
+                }
+
+                // Notify the component arrays holding one of the entity's components that it has been destroyed
+                for(ComponentType type = 0; type < component_arrays_count; type++) {
+                    if(signature.test(type)) {
+                        component_arrays[type]->handle_entity_removed(entity_to_remove);
+                    }
+                }
+
+                // Retire the handle and queue the slot for reuse
+                entity_generations[index] = (entity_generations[index] + 1) % PENDING_GENERATION;
+                free_indices.push_back(index);
+
+                entity_array_count--;
+            }
+
+            bool is_alive(Entity entity) const {
+                std::uint32_t index = entity_index(entity);
+                return index < entity_living.size() && entity_living[index] && entity_generations[index] == entity_generation(entity);
+            }
+
+            Signature get_entity_signature(Entity entity) {
+                ecs_assert(is_alive(entity), "Cannot get entity signature. Entity is not alive.");
+
+                return entity_signatures[entity_index(entity)];
+            }
+
+            template<typename T>
+            void register_component() {
+                constexpr TypeHash hash = type_hash<T>();
+
+                // Checked in release builds too, since a second type with the same hash would be handed the first type's
+                // array, and snapshots would load one type's data into the other's
+                ecs_check(find_component_type(hash) == component_arrays_count, "Cannot register component. Component type " + std::string(typeid(T).name()) + " already registered, or another type has the same name. See ecs::TypeName.");
+                ecs_check(component_arrays_count < MAX_COMPONENTS, "Cannot register component. Too many component types registered.");
+
+                ComponentType type = component_arrays_count;
+                component_hashes[type] = hash;
+                component_arrays[type] = std::pmr::polymorphic_allocator<ComponentArray<T>>(memory_resource).template new_object<ComponentArray<T>>(&current_tick, memory_resource);
+                component_arrays_count++;
+
+                cache_component_type(type_sequence<T>(), hash, type);
+            }
+
+            template<typename T>
+            ComponentType get_component_type() {
+                constexpr TypeHash hash = type_hash<T>();
+                std::size_t sequence = type_sequence<T>();
+
+                if(sequence < type_cache.size() && type_cache[sequence].hash == hash) {
+                    return type_cache[sequence].type;
+                }
+
+                // The type was registered through a different sequence number, which happens when it was registered
+                // by a plugin with its own sequence counter. Find it by hash and remember it under this number too.
+                ComponentType type = find_component_type(hash);
+                ecs_assert(type != component_arrays_count, "Cannot get component type. Component of type " + std::string(typeid(T).name()) + " not registered.");
+                cache_component_type(sequence, hash, type);
+
+                return type;
+            }
+
+            template<typename T>
+            void add_component(Entity entity, T component) {
+                emplace_component<T>(entity, std::move(component));
+            }
+
+            // Constructs the entity's component of type T in place from the arguments and returns it. The component is
+            // never copied, so T may be move-only or lack a default constructor.
+            template<typename T, typename... Args>
+            ComponentReference<T> emplace_component(Entity entity, Args&&... args) {
+                ecs_assert(is_alive(entity), "Cannot add component. Entity is not alive.");
+
+                ComponentArray<T>& component_array = get_component_array<T>();
+                component_array.emplace_component(entity, std::forward<Args>(args)...);
+                entity_signatures[entity_index(entity)].set(get_component_type<T>());
+                update_groups(entity);
+                component_array.notify_added(entity);
+
+                // Joining a packed group may have moved the component
+                return component_array.get_component(entity);
+            }
+
+            // Gives each entity the component at the same position in components. The components are appended to the
+            // component array in one go, and only the groups which involve T are updated.
+            template<typename T>
+            void add_components(std::span<const Entity> entities, std::span<const T> components) {
+                ComponentType type = get_component_type<T>();
+                for(Entity entity : entities) {
+                    ecs_assert(is_alive(entity), "Cannot add components. Entity is not alive.");
+                    entity_signatures[entity_index(entity)].set(type);
+                }
+
+                ComponentArray<T>& component_array = get_component_array<T>();
+                component_array.insert_components(entities, components);
+                update_groups(entities, type);
+
+                for(Entity entity : entities) {
+                    component_array.notify_added(entity);
+                }
+            }
+
+            // Overwrites the entity's existing component of type T, marking it as changed and calling the replace hooks
+            template<typename T>
+            void replace_component(Entity entity, T component) {
+                ecs_assert(is_alive(entity), "Cannot replace component. Entity is not alive.");
+
+                get_component_array<T>().replace_component(entity, std::move(component));
+            }
+
+            // The entity leaves its groups before the component is removed, since packed groups need the component to
+            // still be in its array when the entity leaves
+            template<typename T>
+            void remove_component(Entity entity) {
+                ecs_assert(is_alive(entity), "Cannot remove component. Entity is not alive.");
+
+                ComponentArray<T>& component_array = get_component_array<T>();
+                component_array.notify_removed(entity);
+                entity_signatures[entity_index(entity)].reset(get_component_type<T>());
+                update_groups(entity);
+                component_array.remove_component(entity);
+            }
+
+            // Registers a hook which is called with the entity and its new component after a component of type T is
+            // added, once the entity's signature and views include it. Hooks are called in the order they were
+            // registered. They may read the ECS, but must not add or remove entities or components; a hook which
+            // needs to can record the change in a command buffer.
+            template<typename T>
+            void on_add(std::function<void(Entity, ComponentReference<T>)> hook) {
+                get_component_array<T>().on_add(std::move(hook));
+            }
+
+            // Registers a hook which is called with the previous and the new value after replace_component()
+            // overwrites a component of type T
+            template<typename T>
+            void on_replace(std::function<void(Entity, const T&, ComponentReference<T>)> hook) {
+                get_component_array<T>().on_replace(std::move(hook));
+            }
+
+            // Registers a hook which is called with the entity and its component before a component of type T is
+            // removed, including by remove_entity(). The entity and the component are still intact when it runs.
+            template<typename T>
+            void on_remove(std::function<void(Entity, ComponentReference<T>)> hook) {
+                get_component_array<T>().on_remove(std::move(hook));
+            }
+
+            // Removes the component of type T from each of the entities. The entities are first sorted by where their
+            // components sit in the component array, last first, so most of the removals pop from the back of the
+            // array instead of swapping. Sorts the given list in place.
+            template<typename T>
+            void remove_components(std::vector<Entity>& entities) {
+                ComponentArray<T>& component_array = get_component_array<T>();
+                ComponentType type = get_component_type<T>();
+
+                removal_scratch.clear();
+                for(Entity entity : entities) {
+                    removal_scratch.push_back({ component_array.index_of(entity), entity });
+                }
+                std::sort(removal_scratch.begin(), removal_scratch.end(), [](auto const& a, auto const& b) {
+                    return a.first > b.first;
+                });
+                removal_scratch.erase(std::unique(removal_scratch.begin(), removal_scratch.end()), removal_scratch.end());
+
+                entities.clear();
+                for(auto const& removal : removal_scratch) {
+                    entities.push_back(removal.second);
+                }
+
+                for(Entity entity : entities) {
+                    ecs_assert(is_alive(entity), "Cannot remove component. Entity is not alive.");
+
+                    component_array.notify_removed(entity);
+                    entity_signatures[entity_index(entity)].reset(type);
+                    update_groups(entity);
+                    component_array.remove_component(entity);
+                }
+            }
+
+            // Returns the storage of component type T. The storage lives as long as the world, so a system can look it
+            // up once and keep the reference instead of looking up the type on every access. Components must still be
+            // added and removed through the ECS, which keeps entity signatures and groups up to date.
+            template<typename T>
+            ComponentStorage<T>& storage() {
+                return get_component_array<T>();
+            }
+
+            // Marks the component as changed at the current tick, unless T is const
+            template<typename T>
+            ComponentReference<T> get_component(Entity entity) {
+                check_scheduled_access<T>();
+
+                ComponentArray<std::remove_const_t<T>>& component_array = get_component_array<std::remove_const_t<T>>();
+                if constexpr(std::is_const_v<T>) {
+                    return std::as_const(component_array).get_component(entity);
+                } else {
+                    return component_array.get_component(entity);
+                }
+            }
+
+            std::pmr::memory_resource* get_memory_resource() const {
+                return memory_resource;
+            }
+
+            // The world starts at tick 1, so a system which has never run can ask for everything changed since tick 0
+            Tick get_tick() const {
+                return current_tick.load();
+            }
+
+            // Ends the current tick and returns it. A system which reacts to changes asks for the components changed
+            // since the tick it remembered last time, then ends the tick and remembers that one. Its own changes were
+            // stamped with the remembered tick, so they don't show up again, while any change made after it ran is
+            // stamped with a later tick.
+            //     view.changed<Position>(last_run).each(...);
+            //     last_run = ecs.advance_tick();
+            Tick advance_tick() {
+                return current_tick++;
+            }
+
+            // Writes the world to the buffer as a snapshot, replacing the buffer's contents. Reusing the buffer between
+            // snapshots avoids reallocating it every time. Every registered component type must be trivially copyable
+            // or have a serializer.
+            void save_snapshot(std::vector<std::byte>& buffer) const {
+                buffer.clear();
+                SnapshotWriter writer(buffer);
+
+                SnapshotHeader header = (SnapshotHeader) {
+                    .magic = SNAPSHOT_MAGIC,
+                    .version = SNAPSHOT_VERSION,
+                    .slot_count = (std::uint32_t)entity_living.size(),
+                    .next_unused_index = next_unused_index,
+                    .free_count = (std::uint32_t)free_indices.size(),
+                    .living_count = entity_array_count,
+                    .tick = current_tick.load(),
+                    .component_count = component_arrays_count
+                };
+                writer.write_section(&header, sizeof(header));
+
+                writer.write_section(entity_generations.data(), header.slot_count * sizeof(std::uint32_t));
+                std::span<std::byte> living_section = writer.reserve_section(header.slot_count);
+                for(std::uint32_t i = 0; i < header.slot_count; i++) {
+                    living_section[i] = (std::byte)entity_living[i];
+                }
+                std::size_t signature_words = (header.component_count + 63) / 64;
+                std::span<std::byte> signature_section = writer.reserve_section(header.slot_count * signature_words * sizeof(std::uint64_t));
+                for(std::uint32_t i = 0; i < header.slot_count; i++) {
+                    for(std::size_t word = 0; word < signature_words; word++) {
+                        std::uint64_t value = entity_signatures[i].get_word(word);
+                        std::memcpy(signature_section.data() + (i * signature_words + word) * sizeof(value), &value, sizeof(value));
+                    }
+                }
+                std::span<std::byte> free_section = writer.reserve_section(header.free_count * sizeof(std::uint32_t));
+                std::size_t free_offset = 0;
+                for(std::uint32_t index : free_indices) {
+                    std::memcpy(free_section.data() + free_offset, &index, sizeof(index));
+                    free_offset += sizeof(index);
+                }
+
+                for(ComponentType type = 0; type < component_arrays_count; type++) {
+                    component_arrays[type]->save(writer);
+                }
+            }
+
+            // Replaces the world's entities and components with the ones in the snapshot, and restores the tick.
+            // Component blocks are matched to registered component types by type hash, so the component types must
+            // be registered before loading, though not necessarily in the same order. Registered types which are
+            // missing from the snapshot end up empty. No hooks are called, and existing views are invalidated.
+            //
+            // The snapshot has to be aligned for the component types it holds. A std::vector<std::byte> is aligned
+            // for most types, and a memory mapped file for all of them.
+            //
+            // Snapshots read from disk may be truncated or corrupt, so the whole snapshot is checked before anything is
+            // changed. Returns false, leaving the world as it was, if the data isn't a whole and consistent snapshot of
+            // a supported version, or holds a component type which isn't registered or can't be read back.
+            bool load_snapshot(std::span<const std::byte> snapshot) {
+                if(!check_snapshot(snapshot)) {
+                    return false;
+                }
+
+                SnapshotReader reader(snapshot);
+                SnapshotHeader header = reader.read_section<SnapshotHeader>();
+                ecs_assert(header.magic == SNAPSHOT_MAGIC, "Cannot load snapshot. Data is not a snapshot.");
+                ecs_assert(header.version == SNAPSHOT_VERSION, "Cannot load snapshot. Snapshot version " + std::to_string(header.version) + " is not supported.");
+
+                std::span<const std::uint32_t> loaded_generations = reader.section<std::uint32_t>(header.slot_count);
+                entity_generations.assign(loaded_generations.begin(), loaded_generations.end());
+                std::span<const std::uint8_t> loaded_living = reader.section<std::uint8_t>(header.slot_count);
+                entity_living.assign(loaded_living.begin(), loaded_living.end());
+                std::size_t signature_words = (header.component_count + 63) / 64;
+                std::span<const std::uint64_t> loaded_signatures = reader.section<std::uint64_t>(header.slot_count * signature_words);
+                entity_signatures.resize(header.slot_count);
+                for(std::uint32_t i = 0; i < header.slot_count; i++) {
+                    for(std::size_t word = 0; word < Signature::WORD_COUNT; word++) {
+                        entity_signatures[i].set_word(word, word < signature_words ? loaded_signatures[i * signature_words + word] : 0);
+                    }
+                }
+                std::span<const std::uint32_t> loaded_free_indices = reader.section<std::uint32_t>(header.free_count);
+                free_indices.assign(loaded_free_indices.begin(), loaded_free_indices.end());
+
+                next_unused_index = header.next_unused_index;
+                entity_array_count = header.living_count;
+                current_tick = header.tick;
+
+                // The component blocks are saved in component type order, so a block's position is the component type
+                // it had in the saved world
+                std::array<bool, MAX_COMPONENTS> loaded = {};
+                std::array<ComponentType, MAX_COMPONENTS> saved_types;
+                bool same_types = true;
+                for(std::uint32_t i = 0; i < header.component_count; i++) {
+                    SnapshotComponentHeader component_header = reader.read_section<SnapshotComponentHeader>();
+                    ComponentType type = find_component_type(component_header.hash);
+                    ecs_assert(type != component_arrays_count, "Cannot load snapshot. Snapshot holds a component type which isn't registered.");
+
+                    component_arrays[type]->load(reader, component_header);
+                    loaded[type] = true;
+                    saved_types[i] = type;
+                    same_types = same_types && type == i;
+                }
+                for(ComponentType type = 0; type < component_arrays_count; type++) {
+                    if(!loaded[type]) {
+                        component_arrays[type]->clear();
+                    }
+                }
+
+                // The saved world registered its component types in a different order, so renumber the signatures
+                if(!same_types) {
+                    for(Signature& signature : entity_signatures) {
+                        Signature saved_signature = signature;
+                        signature.reset();
+                        for(std::uint32_t i = 0; i < header.component_count; i++) {
+                            if(saved_signature.test((ComponentType)i)) {
+                                signature.set(saved_types[i]);
+                            }
+                        }
+                    }
+                }
+
+                // Packed groups move their members' components back to the front of their arrays as they refill
+                std::lock_guard<std::mutex> lock(groups_mutex);
+                for(Group& group : groups) {
+                    group.clear();
+                    fill_group(group);
+                }
+
+                return true;
+            }
+
+            // Writes what changed since the baseline, a snapshot saved from this world earlier, to the buffer as a delta,
+            // replacing the buffer's contents. Components are only compared with the baseline if they were added or
+            // handed out mutably since the baseline's tick.
+            void save_delta(const SnapshotView& baseline, std::vector<std::byte>& buffer) const {
+                buffer.clear();
+                SnapshotWriter writer(buffer);
+
+                DeltaHeader header = (DeltaHeader) {
+                    .magic = DELTA_MAGIC,
+                    .version = DELTA_VERSION,
+                    .baseline_tick = baseline.get_tick(),
+                    .tick = current_tick.load(),
+                    .slot_count = (std::uint32_t)entity_living.size(),
+                    .next_unused_index = next_unused_index,
+                    .free_count = (std::uint32_t)free_indices.size(),
+                    .living_count = entity_array_count,
+                    .slot_change_count = 0,
+                    .component_count = 0
+                };
+                writer.write_section(&header, sizeof(header));
+
+                std::span<const std::uint32_t> baseline_generations = baseline.get_generations();
+                std::span<const std::uint8_t> baseline_living = baseline.get_living();
+                std::size_t slot_count = std::max(entity_living.size(), baseline_generations.size());
+                writer.write_section(nullptr, 0);
+                for(std::uint32_t i = 0; i < slot_count; i++) {
+                    DeltaSlot slot = (DeltaSlot) {
+                        .index = i,
+                        .generation = i < entity_generations.size() ? entity_generations[i] : 0,
+                        .living = i < entity_living.size() && entity_living[i]
+                    };
+                    std::uint32_t baseline_generation = i < baseline_generations.size() ? baseline_generations[i] : 0;
+                    std::uint32_t was_living = i < baseline_living.size() && baseline_living[i];
+                    if(slot.generation != baseline_generation || slot.living != was_living) {
+                        writer.write(slot);
+                        header.slot_change_count++;
+                    }
+                }
+
+                writer.write_section(nullptr, 0);
+                for(std::uint32_t index : free_indices) {
+                    writer.write(index);
+                }
+
+                std::function<bool(Entity)> alive = [this](Entity entity) {
+                    return is_alive(entity);
+                };
+                for(ComponentType type = 0; type < component_arrays_count; type++) {
+                    if(component_arrays[type]->save_delta(writer, baseline, alive)) {
+                        header.component_count++;
+                    }
+                }
+
+                writer.overwrite(0, header);
+            }
+
+            // Applies a delta to this world, which must be in the state of the delta's baseline, for instance after
+            // loading the baseline snapshot or applying the deltas which led up to it. Entities and components are
+            // removed, added and replaced through the same paths as remove_entity(), add_component() and
+            // replace_component(), so hooks are called and views stay up to date. Changed components are marked with
+            // this world's current tick.
+            //
+            // Deltas are sent over the network, so the whole delta is checked against the world before anything is
+            // changed. Returns false, leaving the world as it was, if the data isn't a whole and consistent delta of a
+            // supported version, or holds a component type which isn't registered or can't be read back.
+            bool apply_delta(std::span<const std::byte> delta) {
+                if(!check_delta(delta)) {
+                    return false;
+                }
+
+                SnapshotReader reader(delta);
+                DeltaHeader header = reader.read_section<DeltaHeader>();
+                ecs_assert(header.magic == DELTA_MAGIC, "Cannot apply delta. Data is not a delta.");
+                ecs_assert(header.version == DELTA_VERSION, "Cannot apply delta. Delta version " + std::to_string(header.version) + " is not supported.");
+
+                if(header.slot_count > entity_living.size()) {
+                    grow_entity_arrays(header.slot_count);
+                }
+
+                // A slot which changed held a different entity in the baseline, or none
+                for(DeltaSlot slot : reader.section<DeltaSlot>(header.slot_change_count)) {
+                    if(slot.index >= entity_living.size()) {
+                        grow_entity_arrays(slot.index + 1);
+                    }
+                    if(entity_living[slot.index]) {
+                        remove_entity(make_entity(slot.index, entity_generations[slot.index]));
+                    }
+
+                    entity_generations[slot.index] = slot.generation;
+                    entity_living[slot.index] = slot.living != 0;
+                    if(slot.living) {
+                        update_groups(make_entity(slot.index, slot.generation));
+                    }
+                }
+
+                std::span<const std::uint32_t> loaded_free_indices = reader.section<std::uint32_t>(header.free_count);
+                free_indices.assign(loaded_free_indices.begin(), loaded_free_indices.end());
+                next_unused_index = header.next_unused_index;
+                entity_array_count = header.living_count;
+
+                std::vector<Entity> added;
+                for(std::uint32_t i = 0; i < header.component_count; i++) {
+                    DeltaComponentHeader component_header = reader.read_section<DeltaComponentHeader>();
+                    ComponentType type = find_component_type(component_header.hash);
+                    ecs_assert(type != component_arrays_count, "Cannot apply delta. Delta holds a component type which isn't registered.");
+
+                    for(Entity entity : reader.section<Entity>(component_header.removed_count)) {
+                        if(!is_alive(entity) || !entity_signatures[entity_index(entity)].test(type)) {
+                            continue;
+                        }
+                        component_arrays[type]->notify_removed(entity);
+                        entity_signatures[entity_index(entity)].reset(type);
+                        update_groups(entity);
+                        component_arrays[type]->handle_entity_removed(entity);
+                    }
+
+                    added.clear();
+                    component_arrays[type]->apply_delta(reader, component_header, added);
+                    for(Entity entity : added) {
+                        entity_signatures[entity_index(entity)].set(type);
+                        update_groups(entity);
+                        component_arrays[type]->notify_added(entity);
+                    }
+                }
+
+                return true;
+            }
+
+            // See ComponentArray::set_serializer()
+            template<typename T>
+            void set_serializer(std::function<void(SnapshotWriter&, const T&)> serializer, std::function<T(SnapshotReader&)> deserializer) {
+                get_component_array<T>().set_serializer(std::move(serializer), std::move(deserializer));
+            }
+
+            // Packs the component arrays of the listed types so that the entities which have all of them sit at the
+            // front of every one of those arrays, in the same order. Views of exactly these component types then
+            // iterate the arrays in lockstep without any lookups, like iterating the columns of an archetype table.
+            // The ECS keeps the arrays packed as components are added and removed. A component type can only be
+            // packed by one set of types.
+            template<typename ...rest>
+            View<rest...> pack() {
+                static_assert(!(ViewComponent<rest>::optional || ...), "Cannot pack optional components.");
+
+                Signature system_signature;
+                get_system_signature<rest...>(system_signature);
+
+                Group* group = get_group(system_signature, Signature());
+                if(!group->is_packed()) {
+                    for(ComponentType type = 0; type < component_arrays_count; type++) {
+                        ecs_assert(!system_signature.test(type) || !component_packed[type], "Cannot pack components. A component type is already packed by another set of types.");
+                        if(system_signature.test(type)) {
+                            component_packed[type] = true;
+                        }
+                    }
+                    group->pack({ &get_component_array<typename ViewComponent<rest>::type>()... });
+                }
+
+                return View<rest...>(this, group, &get_component_array<typename ViewComponent<rest>::type>()...);
+            }
+
+            // Component types wrapped in ecs::Optional don't count towards the view's signature, so a view needs at least
+            // one type which isn't optional
+            template<typename ...rest>
+            View<rest...> view() {
+                return view<rest...>(Signature());
+            }
+
+            // Returns the view of the entities which have the listed component types and none of the excluded ones. Only
+            // the filtered group is built, unlike with view<...>().without<...>().
+            template<typename ...rest, typename... Excluded>
+            View<rest...> view(Exclude<Excluded...>) {
+                Signature excluded;
+                (excluded.set(get_component_type<Excluded>()), ...);
+
+                return view<rest...>(excluded);
+            }
+
+            // Returns the view of the entities which have the listed component types and none of the component types in
+            // the excluded signature
+            template<typename ...rest>
+            View<rest...> view(const Signature& excluded) {
+                static_assert(!(ViewComponent<rest>::optional && ...), "Cannot create view. At least one component type must not be optional.");
+                check_scheduled_access<rest...>();
+
+                Signature system_signature;
+                get_system_signature<rest...>(system_signature);
+
+                return View<rest...>(this, get_group(system_signature, excluded), &get_component_array<typename ViewComponent<rest>::type>()...);
+            }
+        private:
+            std::pmr::memory_resource* memory_resource;
+
+            std::pmr::vector<bool> entity_living;
+            std::pmr::vector<std::uint32_t> entity_generations;
+            std::pmr::vector<Signature> entity_signatures;
+            std::pmr::deque<std::uint32_t> free_indices;
+            std::uint32_t next_unused_index;
+            Entity entity_array_count;
+
+            struct TypeCacheEntry {
+                TypeHash hash;
+                ComponentType type;
+            };
+
+            // Component arrays and their type hashes, indexed by component type
+            std::array<IComponentArray*, MAX_COMPONENTS> component_arrays = {};
+            std::array<TypeHash, MAX_COMPONENTS> component_hashes;
+            std::array<bool, MAX_COMPONENTS> component_packed = {};
+            ComponentType component_arrays_count;
+
+            std::atomic<Tick> current_tick;
+
+            // Maps type sequence numbers to component types
+            std::pmr::vector<TypeCacheEntry> type_cache;
+
+            // A deque never moves its elements, so views can keep pointers to groups while new groups are added
+            std::pmr::deque<Group> groups;
+            std::mutex groups_mutex;
+
+            // Reused by remove_components() so batched removals don't allocate once it has grown
+            std::pmr::vector<std::pair<std::size_t, Entity>> removal_scratch;
+
+            // Grows the entity arrays to hold at least minimum_size slots. Small worlds start at MIN_ENTITY_CAPACITY
+            // slots and double, and once they reach ENTITY_CHUNK_SIZE slots they grow a chunk at a time. The new slots
+            // are handed out from next_unused_index.
+            void grow_entity_arrays(std::size_t minimum_size) {
+                // Checked in release builds too, since handing out an index past MAX_ENTITIES would corrupt handles
+                ecs_check(minimum_size <= MAX_ENTITIES, "Cannot create entity. Entity index space is exhausted.");
+
+                std::size_t size = entity_living.size();
+                std::size_t new_size = std::max<std::size_t>(MIN_ENTITY_CAPACITY, size + std::min<std::size_t>(size, ENTITY_CHUNK_SIZE));
+                new_size = std::min<std::size_t>(std::max(new_size, minimum_size), MAX_ENTITIES);
+                entity_living.resize(new_size, false);
+                entity_generations.resize(new_size, 0);
+                entity_signatures.resize(new_size);
+            }
+
+
+            // Returns the group for the signatures, building it from the living entities if no view has asked for it yet.
+            // Systems running in parallel may ask for views at the same time, so the group list is locked.
+            Group* get_group(const Signature& signature, const Signature& excluded) {
+                std::lock_guard<std::mutex> lock(groups_mutex);
+
+                for(Group& group : groups) {
+                    if(group.get_signature() == signature && group.get_excluded() == excluded) {
+                        return &group;
+                    }
+                }
+
+                groups.emplace_back(signature, excluded, memory_resource);
+                Group* group = &groups.back();
+                fill_group(*group);
+
+                return group;
+            }
+
+            // Walks a snapshot the way load_snapshot() does and checks that it is whole, that every component block is
+            // of a registered type which can read it, and that the slots, free slot queue, signatures and component
+            // owners agree with each other, so that loading it can't corrupt the world
+            bool check_snapshot(std::span<const std::byte> snapshot) const {
+                SnapshotReader reader(snapshot);
+                SnapshotHeader header = reader.read_section<SnapshotHeader>();
+                if(!reader.ok() || header.magic != SNAPSHOT_MAGIC || header.version != SNAPSHOT_VERSION) {
+                    return false;
+                }
+                if(header.slot_count > MAX_ENTITIES || header.next_unused_index > header.slot_count || header.free_count > header.slot_count || header.component_count > component_arrays_count) {
+                    return false;
+                }
+
+                std::span<const std::uint32_t> generations = reader.section<std::uint32_t>(header.slot_count);
+                std::span<const std::uint8_t> living = reader.section<std::uint8_t>(header.slot_count);
+                std::size_t signature_words = (header.component_count + 63) / 64;
+                std::span<const std::uint64_t> signatures = reader.section<std::uint64_t>(header.slot_count * signature_words);
+                std::span<const std::uint32_t> loaded_free_indices = reader.section<std::uint32_t>(header.free_count);
+                if(!reader.ok()) {
+                    return false;
+                }
+
+                // Slots which are never handed out can't hold a living entity
+                std::uint32_t living_count = 0;
+                for(std::uint32_t i = 0; i < header.slot_count; i++) {
+                    if(living[i] > 1 || (living[i] && i >= header.next_unused_index) || generations[i] >= PENDING_GENERATION) {
+                        return false;
+                    }
+                    living_count += living[i];
+                }
+                if(living_count != header.living_count) {
+                    return false;
+                }
+
+                // Stamps each slot with the last list it was seen in, 1 for the free slot queue and i + 2 for the i-th
+                // component block, to catch slots which are listed twice
+                std::vector<std::uint32_t> seen(header.slot_count, 0);
+                for(std::uint32_t index : loaded_free_indices) {
+                    if(index >= header.next_unused_index || living[index] || seen[index] != 0) {
+                        return false;
+                    }
+                    seen[index] = 1;
+                }
+
+                // Each component block must hold exactly the living entities whose signature has its bit set
+                std::vector<std::uint32_t> owner_counts(header.component_count, 0);
+                for(std::uint32_t i = 0; i < header.slot_count; i++) {
+                    for(std::size_t word = 0; word < signature_words; word++) {
+                        std::uint64_t bits = signatures[i * signature_words + word];
+                        if(bits != 0 && !living[i]) {
+                            return false;
+                        }
+                        for(; bits != 0; bits &= bits - 1) {
+                            std::size_t saved_type = word * 64 + std::countr_zero(bits);
+                            if(saved_type >= header.component_count) {
+                                return false;
+                            }
+                            owner_counts[saved_type]++;
+                        }
+                    }
+                }
+
+                std::array<bool, MAX_COMPONENTS> found = {};
+                for(std::uint32_t i = 0; i < header.component_count; i++) {
+                    SnapshotComponentHeader component_header = reader.read_section<SnapshotComponentHeader>();
+                    ComponentType type = find_component_type(component_header.hash);
+                    if(!reader.ok() || type == component_arrays_count || found[type] || component_header.count != owner_counts[i]) {
+                        return false;
+                    }
+                    found[type] = true;
+
+                    for(Entity entity : reader.section<Entity>(component_header.count)) {
+                        std::uint32_t index = entity_index(entity);
+                        if(index >= header.slot_count || !living[index] || generations[index] != entity_generation(entity) || seen[index] == i + 2) {
+                            return false;
+                        }
+                        if(((signatures[index * signature_words + i / 64] >> (i % 64)) & 1) == 0) {
+                            return false;
+                        }
+                        seen[index] = i + 2;
+                    }
+                    reader.section<Tick>(component_header.count);
+                    reader.section<Tick>(component_header.count);
+
+                    // Raw values are read as one section of count values, serialized ones as value_bytes bytes
+                    if(component_header.value_size != 0 && component_header.value_bytes != (std::uint64_t)component_header.count * component_header.value_size) {
+                        return false;
+                    }
+                    std::span<const std::byte> values = reader.section<std::byte>(component_header.value_bytes);
+                    if(!reader.ok() || !component_arrays[type]->accepts(component_header.value_size, values.empty() ? nullptr : values.data())) {
+                        return false;
+                    }
+                }
+
+                return true;
+            }
+
+            // Walks a delta the way apply_delta() does and checks that it is whole, that every component block is of a
+            // registered type which can read it, and that the slots it changes, its free slot queue and the owners of
+            // its changed components agree with this world once the slot changes are applied
+            bool check_delta(std::span<const std::byte> delta) const {
+                SnapshotReader reader(delta);
+                DeltaHeader header = reader.read_section<DeltaHeader>();
+                if(!reader.ok() || header.magic != DELTA_MAGIC || header.version != DELTA_VERSION) {
+                    return false;
+                }
+                if(header.slot_count > MAX_ENTITIES || header.next_unused_index > header.slot_count || header.free_count > header.slot_count) {
+                    return false;
+                }
+
+                std::span<const DeltaSlot> slots = reader.section<DeltaSlot>(header.slot_change_count);
+                std::span<const std::uint32_t> loaded_free_indices = reader.section<std::uint32_t>(header.free_count);
+                if(!reader.ok()) {
+                    return false;
+                }
+
+                // Slots are written in increasing index order, which lets the final state of a slot be looked up below
+                std::size_t slot_count = std::max<std::size_t>(entity_living.size(), header.slot_count);
+                Entity living_count = entity_array_count;
+                for(std::size_t i = 0; i < slots.size(); i++) {
+                    const DeltaSlot& slot = slots[i];
+                    if(slot.index >= MAX_ENTITIES || (i > 0 && slot.index <= slots[i - 1].index) || slot.living > 1 || slot.generation >= PENDING_GENERATION) {
+                        return false;
+                    }
+                    if(slot.living && slot.index >= header.next_unused_index) {
+                        return false;
+                    }
+                    slot_count = std::max<std::size_t>(slot_count, slot.index + 1);
+                    living_count -= slot.index < entity_living.size() && entity_living[slot.index];
+                    living_count += slot.living;
+                }
+                if(living_count != header.living_count) {
+                    return false;
+                }
+
+                // The living flag and generation of a slot once the slot changes are applied
+                auto slot_after = [this, slots](std::uint32_t index) -> std::pair<bool, std::uint32_t> {
+                    auto slot = std::lower_bound(slots.begin(), slots.end(), index, [](const DeltaSlot& slot, std::uint32_t index) {
+                        return slot.index < index;
+                    });
+                    if(slot != slots.end() && slot->index == index) {
+                        return { slot->living != 0, slot->generation };
+                    }
+                    if(index < entity_living.size()) {
+                        return { entity_living[index], entity_generations[index] };
+                    }
+
+                    return { false, 0 };
+                };
+
+                std::vector<bool> freed(slot_count, false);
+                for(std::uint32_t index : loaded_free_indices) {
+                    if(index >= header.next_unused_index || freed[index] || slot_after(index).first) {
+                        return false;
+                    }
+                    freed[index] = true;
+                }
+
+                std::array<bool, MAX_COMPONENTS> found = {};
+                for(std::uint32_t i = 0; i < header.component_count; i++) {
+                    DeltaComponentHeader component_header = reader.read_section<DeltaComponentHeader>();
+                    ComponentType type = find_component_type(component_header.hash);
+                    if(!reader.ok() || type == component_arrays_count || found[type] || !component_arrays[type]->accepts(component_header.value_size, nullptr)) {
+                        return false;
+                    }
+                    found[type] = true;
+
+                    // Removed entities which aren't alive, or lack the component, are skipped when applying
+                    reader.section<Entity>(component_header.removed_count);
+                    for(Entity entity : reader.section<Entity>(component_header.changed_count)) {
+                        auto [living, generation] = slot_after(entity_index(entity));
+                        if(!living || generation != entity_generation(entity)) {
+                            return false;
+                        }
+                    }
+                    if(component_header.value_size != 0 && component_header.value_bytes != (std::uint64_t)component_header.changed_count * component_header.value_size) {
+                        return false;
+                    }
+                    reader.section<std::byte>(component_header.value_bytes);
+                    if(!reader.ok()) {
+                        return false;
+                    }
+                }
+
+                return true;
+            }
+
+            // Inserts every living entity which matches the group
+            void fill_group(Group& group) {
+                // No entity can match if one of the required component arrays is empty, so skip the scan
+                for(ComponentType type = 0; type < component_arrays_count; type++) {
+                    if(group.get_signature().test(type) && component_arrays[type]->size() == 0) {
+                        return;
+                    }
+                }
+
+                // Removed entities have their signature cleared, so they only match an empty signature
+                match_signatures(entity_signatures.data(), entity_signatures.size(), group.get_signature(), group.get_excluded(), [this, &group](std::size_t i) {
+                    if(entity_living[i]) {
+                        group.insert(make_entity((std::uint32_t)i, entity_generations[i]));
+                    }
+                });
+            }
+
+            // Moves the entity into or out of each group to match its current signature
+            void update_groups(Entity entity) {
+                const Signature& signature = entity_signatures[entity_index(entity)];
+
+                for(Group& group : groups) {
+                    bool in_group = group.contains(entity);
+                    bool matches = group.matches(signature);
+
+                    if(matches && !in_group) {
+                        group.insert(entity);
+                    } else if(!matches && in_group) {
+                        group.remove(entity);
+                    }
+                }
+            }
+
+            // Like update_groups(entity) for many entities whose signatures only differ in the given type. Groups which
+            // neither require nor exclude the type can't have changed and are skipped.
+            void update_groups(std::span<const Entity> entities, ComponentType changed_type) {
+                for(Group& group : groups) {
+                    if(!group.get_signature().test(changed_type) && !group.get_excluded().test(changed_type)) {
+                        continue;
+                    }
+
+                    for(Entity entity : entities) {
+                        bool in_group = group.contains(entity);
+                        bool matches = group.matches(entity_signatures[entity_index(entity)]);
+
+                        if(matches && !in_group) {
+                            group.insert(entity);
+                        } else if(!matches && in_group) {
+                            group.remove(entity);
+                        }
+                    }
+                }
+            }
+
+            // Returns the component type registered with the hash, or component_arrays_count if there is none
+            ComponentType find_component_type(TypeHash hash) const {
+                for(ComponentType type = 0; type < component_arrays_count; type++) {
+                    if(component_hashes[type] == hash) {
+                        return type;
+                    }
+                }
+
+                return component_arrays_count;
+            }
+
+            void cache_component_type(std::size_t sequence, TypeHash hash, ComponentType type) {
+                if(sequence >= type_cache.size()) {
+                    type_cache.resize(sequence + 1, (TypeCacheEntry) { .hash = 0, .type = 0 });
+                }
+                type_cache[sequence] = (TypeCacheEntry) { .hash = hash, .type = type };
+            }
+
+            template<typename T>
+            ComponentArray<T>& get_component_array() {
+                return *static_cast<ComponentArray<T>*>(component_arrays[get_component_type<T>()]);
+            }
+
+            template<typename T>
+            void get_system_signature(Signature& signature) {
+                if constexpr(!ViewComponent<T>::optional) {
+                    signature.set(get_component_type<typename ViewComponent<T>::type>());
+                }
+            }
+
+            template<typename T, typename U, typename... rest>
+            void get_system_signature(Signature& signature) {
+                get_system_signature<T>(signature);
+                get_system_signature<U, rest...>(signature);
+            }
+
+            // Asserts that a scheduled system running on this thread declared every non-const type as written
+            template<typename... rest>
+            void check_scheduled_access() {
+#ifndef NDEBUG
+                if(scheduled_writes == nullptr) {
+                    return;
+                }
+
+                Signature mutable_types;
+                ((std::is_const_v<typename ViewComponent<rest>::access> ? void() : mutable_types.set(get_component_type<typename ViewComponent<rest>::type>())), ...);
+                ecs_assert(scheduled_writes->contains(mutable_types), "Cannot access components. A scheduled system asked for mutable access to a component type it didn't declare as written. Use a const type for components it reads.");
+#endif
+            }
+
+    };
+
+    template<typename... Components>
+    template<typename... Excluded>
+    View<Components...> View<Components...>::without() const {
+        Signature excluded = group->get_excluded();
+        (excluded.set(world->template get_component_type<Excluded>()), ...);
+
+        View result = world->template view<Components...>(excluded);
+        result.filter = filter;
+        return result;
+    }
+
+    // Records structural changes so that they can be applied later in one batch, at a point where nothing is
+    // iterating over the ECS. Systems iterating a view, or running in parallel, can record changes into a command
+    // buffer and have them applied once they're done.
+    //
+    // flush() creates the entities, then applies each component type's adds and removes in the order they were recorded,
+    // then removes the entities. Runs of consecutive component removals are batched, and removed entities are sorted by
+    // index, so the component arrays are walked in order instead of at random. Commands for an entity which is no
+    // longer alive, and removals of a component the entity no longer has, are skipped, so buffers which were recorded
+    // independently (such as those of ThreadCommandBuffers) can't corrupt the ECS when they conflict.
+    class CommandBuffer {
+        public:
+            CommandBuffer(ECS& ecs) : ecs(ecs), created_entity_count(0) {}
+
+            CommandBuffer(const CommandBuffer&) = delete;
+            CommandBuffer& operator=(const CommandBuffer&) = delete;
+
+            // Returns a placeholder for an entity which is created when the buffer is flushed. The placeholder can be
+            // passed to this buffer's other functions, but not to the ECS or to other command buffers.
+            Entity create_entity() {
+                return make_entity(created_entity_count++, PENDING_GENERATION);
+            }
+
+            void remove_entity(Entity entity) {
+                removed_entities.push_back(entity);
+            }
+
+            template<typename T>
+            void add_component(Entity entity, T component) {
+                get_component_commands<T>().commands.push_back({ entity, std::move(component) });
+            }
+
+            template<typename T>
+            void remove_component(Entity entity) {
+                get_component_commands<T>().commands.push_back({ entity, std::nullopt });
+            }
+
+            bool empty() const {
+                if(created_entity_count > 0 || !removed_entities.empty()) {
+                    return false;
+                }
+                for(auto const& commands : component_commands) {
+                    if(commands && !commands->empty()) {
+                        return false;
+                    }
+                }
+
+                return true;
+            }
+
+            // Applies the recorded commands to the ECS and clears the buffer
+            void flush() {
+                created_entities.clear();
+                for(std::uint32_t i = 0; i < created_entity_count; i++) {
+                    created_entities.push_back(ecs.create_entity());
+                }
+
+                for(auto const& commands : component_commands) {
+                    if(commands) {
+                        commands->apply(ecs, created_entities);
+                    }
+                }
+
+                for(Entity& entity : removed_entities) {
+                    entity = resolve(entity, created_entities);
+                }
+                std::sort(removed_entities.begin(), removed_entities.end(), [](Entity a, Entity b) {
+                    return entity_index(a) < entity_index(b);
+                });
+                removed_entities.erase(std::unique(removed_entities.begin(), removed_entities.end()), removed_entities.end());
+                for(Entity entity : removed_entities) {
+                    ecs.remove_entity(entity);
+                }
+
+                clear();
+            }
+
+            void clear() {
+                created_entity_count = 0;
+                removed_entities.clear();
+                for(auto const& commands : component_commands) {
+                    if(commands) {
+                        commands->clear();
+                    }
+                }
+            }
+
+            // Maps a placeholder from create_entity() to the entity that was created for it. Other entities are
+            // returned unchanged.
+            static Entity resolve(Entity entity, const std::vector<Entity>& created_entities) {
+                if(entity_generation(entity) == PENDING_GENERATION) {
+                    return created_entities[entity_index(entity)];
+                }
+
+                return entity;
+            }
+        private:
+            class IComponentCommands {
+                public:
+                    virtual ~IComponentCommands() = default;
+                    virtual void apply(ECS& ecs, const std::vector<Entity>& created_entities) = 0;
+                    virtual void clear() = 0;
+                    virtual bool empty() const = 0;
+            };
+
+            template<typename T>
+            class ComponentCommands : public IComponentCommands {
+                public:
+                    // Adds carry the component, removals carry none
+                    std::vector<std::pair<Entity, std::optional<T>>> commands;
+
+                    void apply(ECS& ecs, const std::vector<Entity>& created_entities) override {
+                        ComponentStorage<T>& storage = ecs.storage<T>();
+
+                        std::size_t i = 0;
+                        while(i < commands.size()) {
+                            if(commands[i].second) {
+                                Entity entity = resolve(commands[i].first, created_entities);
+                                if(ecs.is_alive(entity)) {
+                                    ecs.add_component<T>(entity, std::move(*commands[i].second));
+                                }
+                                i++;
+                                continue;
+                            }
+
+                            removed.clear();
+                            for(; i < commands.size() && !commands[i].second; i++) {
+                                Entity entity = resolve(commands[i].first, created_entities);
+                                if(ecs.is_alive(entity) && storage.has_component(entity)) {
+                                    removed.push_back(entity);
+                                }
+                            }
+                            if(!removed.empty()) {
+                                ecs.remove_components<T>(removed);
+                            }
+                        }
+                    }
+
+                    void clear() override {
+                        commands.clear();
+                    }
+
+                    bool empty() const override {
+                        return commands.empty();
+                    }
+                private:
+                    std::vector<Entity> removed;
+            };
+
+            ECS& ecs;
+            std::uint32_t created_entity_count;
+            std::vector<Entity> created_entities;
+            std::vector<Entity> removed_entities;
+            std::array<std::unique_ptr<IComponentCommands>, MAX_COMPONENTS> component_commands;
+
+            template<typename T>
+            ComponentCommands<T>& get_component_commands() {
+                std::unique_ptr<IComponentCommands>& commands = component_commands[ecs.get_component_type<T>()];
+                if(!commands) {
+                    commands = std::make_unique<ComponentCommands<T>>();
+                }
+
+                return static_cast<ComponentCommands<T>&>(*commands);
+            }
+    };
+
+    // Hands each thread its own command buffer, so systems running in parallel can record commands without locking
+    // on every command. flush() applies the buffers one after another, in the order the threads first asked for them.
+    class ThreadCommandBuffers {
+        public:
+            ThreadCommandBuffers(ECS& ecs) : ecs(ecs), id(next_id++) {}
+
+            // Returns the calling thread's command buffer. Each thread remembers the buffer it was last handed, so only
+            // a thread's first call, or a call after it used another ThreadCommandBuffers, takes the lock.
+            CommandBuffer& local() {
+                if(cached_owner_id == id) {
+                    return *cached_buffer;
+                }
+
+                std::thread::id thread_id = std::this_thread::get_id();
+                std::lock_guard<std::mutex> lock(buffers_mutex);
+
+                CommandBuffer* buffer = nullptr;
+                for(auto& entry : buffers) {
+                    if(entry.first == thread_id) {
+                        buffer = entry.second.get();
+                    }
+                }
+                if(buffer == nullptr) {
+                    buffers.push_back({ thread_id, std::make_unique<CommandBuffer>(ecs) });
+                    buffer = buffers.back().second.get();
+                }
+
+                cached_owner_id = id;
+                cached_buffer = buffer;
+                return *buffer;
+            }
+
+            void flush() {
+                std::lock_guard<std::mutex> lock(buffers_mutex);
+
+                for(auto& buffer : buffers) {
+                    buffer.second->flush();
+                }
+            }
+        private:
+            ECS& ecs;
+            std::vector<std::pair<std::thread::id, std::unique_ptr<CommandBuffer>>> buffers;
+            std::mutex buffers_mutex;
+
+            // The cache is keyed by a unique id instead of the address, which a later instance could reuse
+            std::uint64_t id;
+            static inline std::atomic<std::uint64_t> next_id = 1;
+            static inline thread_local std::uint64_t cached_owner_id = 0;
+            static inline thread_local CommandBuffer* cached_buffer = nullptr;
+    };
+
+    // Component access tags for Scheduler::add_system
+    template<typename... Components>
+    struct Reads {};
+
+    template<typename... Components>
+    struct Writes {};
+
+    // Runs systems on a thread pool. Each system declares which component types it reads and which it writes, and
+    // two systems conflict if either one writes a component type the other one touches. Conflicting systems run in
+    // the order they were added, and all other systems may run in parallel.
+    //
+    // Mutable access marks components as changed, so a system reads a type through const view types and only gets
+    // mutable access to the types it writes. Debug builds assert this.
+    //
+    // Systems which run in parallel must not add or remove entities or components. A system which does has to be
+    // added with add_exclusive_system, which conflicts with every other system.
+    //     scheduler.add_system<ecs::Reads<Velocity>, ecs::Writes<Position>>([](ecs::ECS& ecs) {
+    //         ecs.view<Position, const Velocity>().each([](Position& position, const Velocity& velocity) { ... });
+    //     });
+    class Scheduler {
+        public:
+            Scheduler(ECS& ecs, ThreadPool& thread_pool) : ecs(ecs), thread_pool(thread_pool) {}
+
+            template<typename... Access>
+            void add_system(std::function<void(ECS&)> function) {
+                System system;
+                system.function = std::move(function);
+                system.exclusive = false;
+                (declare_access(system, Access{}), ...);
+
+                add(std::move(system));
+            }
+
+            void add_exclusive_system(std::function<void(ECS&)> function) {
+                System system;
+                system.function = std::move(function);
+                system.exclusive = true;
+
+                add(std::move(system));
+            }
+
+            // Runs every system once and returns when all of them have finished
+            void run() {
+                if(systems.empty()) {
+                    return;
+                }
+
+                for(System& system : systems) {
+                    system.remaining_dependencies = system.dependency_count;
+                }
+                pending_systems = systems.size();
+
+                for(std::size_t i = 0; i < systems.size(); i++) {
+                    if(systems[i].dependency_count == 0) {
+                        submit_system(i);
+                    }
+                }
+
+                thread_pool.wait(pending_systems);
+            }
+        private:
+            struct System {
+                std::function<void(ECS&)> function;
+                Signature reads;
+                Signature writes;
+                bool exclusive;
+
+                // Systems added later that conflict with this one, and the number of earlier ones this one waits for
+                std::vector<std::size_t> dependents;
+                std::size_t dependency_count = 0;
+                std::atomic<std::size_t> remaining_dependencies = 0;
+
+                System() = default;
+                System(System&& other) : function(std::move(other.function)), reads(other.reads), writes(other.writes),
+                    exclusive(other.exclusive), dependents(std::move(other.dependents)), dependency_count(other.dependency_count) {}
+            };
+
+            ECS& ecs;
+            ThreadPool& thread_pool;
+            std::deque<System> systems;
+            std::atomic<std::size_t> pending_systems = 0;
+
+            template<typename... Components>
+            void declare_access(System& system, Reads<Components...>) {
+                (system.reads.set(ecs.get_component_type<std::remove_const_t<Components>>()), ...);
+            }
+
+            template<typename... Components>
+            void declare_access(System& system, Writes<Components...>) {
+                (system.writes.set(ecs.get_component_type<std::remove_const_t<Components>>()), ...);
+            }
+
+            static bool conflicts(const System& a, const System& b) {
+                return a.exclusive || b.exclusive
+                    || (a.writes & (b.reads | b.writes)).any()
+                    || (b.writes & a.reads).any();
+            }
+
+            void add(System system) {
+                std::size_t index = systems.size();
+                for(std::size_t i = 0; i < index; i++) {
+                    if(conflicts(systems[i], system)) {
+                        systems[i].dependents.push_back(index);
+                        system.dependency_count++;
+                    }
+                }
+
+                systems.push_back(std::move(system));
+            }
+
+            void submit_system(std::size_t index) {
+                thread_pool.submit([this, index]() {
+                    System& system = systems[index];
+
+                    // Waiting inside a system may run another system on this thread, so restore the outer one's writes
+                    const Signature* outer_writes = scheduled_writes;
+                    scheduled_writes = system.exclusive ? nullptr : &system.writes;
+                    system.function(ecs);
+                    scheduled_writes = outer_writes;
+
+                    for(std::size_t dependent : system.dependents) {
+                        if(systems[dependent].remaining_dependencies.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                            submit_system(dependent);
+                        }
+                    }
+                    pending_systems.fetch_sub(1, std::memory_order_release);
+                });
+            }
+    };
+
+    // A component type made of two floats or two 32 bit ints named x and y, like a position or a velocity
+    template<typename V>
+    concept Vec2Component = std::is_standard_layout_v<V> && std::is_trivially_copyable_v<V>
+        && std::is_same_v<decltype(V::x), decltype(V::y)>
+        && (std::is_same_v<decltype(V::x), float> || std::is_same_v<decltype(V::x), std::int32_t>)
+        && sizeof(V) == 2 * sizeof(decltype(V::x));
+
+    // Adds each velocity times the scale to the position at the same index. The two types must have the same lane type.
+    // Meant for the spans each_chunk() hands
+    // out, and treats them as flat arrays of lanes, eight at a time with AVX2, four at a time with SSE2 (floats only,
+    // or ints with a scale of one), and one at a time otherwise. Define ECS_NO_SIMD to force the scalar version.
+    //     view.each_chunk([](std::span<Position> positions, std::span<const Velocity> velocities) {
+    //         ecs::integrate_vec2(positions, velocities, delta_time);
+    //     });
+    template<Vec2Component P, Vec2Component V>
+        requires std::is_same_v<decltype(P::x), decltype(V::x)>
+    void integrate_vec2(std::span<P> positions, std::span<const V> velocities, decltype(P::x) scale = 1) {
+        ecs_assert(positions.size() == velocities.size(), "Cannot integrate. There must be one velocity per position.");
+
+        using Lane = decltype(P::x);
+        Lane* position_lanes = reinterpret_cast<Lane*>(positions.data());
+        const Lane* velocity_lanes = reinterpret_cast<const Lane*>(velocities.data());
+        std::size_t lane_count = positions.size() * 2;
+        std::size_t lane = 0;
+#if defined(__AVX2__) && !defined(ECS_NO_SIMD)
+        if constexpr(std::is_same_v<Lane, float>) {
+            __m256 scales = _mm256_set1_ps(scale);
+            for(; lane + 8 <= lane_count; lane += 8) {
+                __m256 position = _mm256_loadu_ps(position_lanes + lane);
+                __m256 velocity = _mm256_loadu_ps(velocity_lanes + lane);
+                _mm256_storeu_ps(position_lanes + lane, _mm256_add_ps(position, _mm256_mul_ps(velocity, scales)));
+            }
+        } else {
+            __m256i scales = _mm256_set1_epi32(scale);
+            for(; lane + 8 <= lane_count; lane += 8) {
+                __m256i position = _mm256_loadu_si256((const __m256i*)(position_lanes + lane));
+                __m256i velocity = _mm256_loadu_si256((const __m256i*)(velocity_lanes + lane));
+                _mm256_storeu_si256((__m256i*)(position_lanes + lane), _mm256_add_epi32(position, _mm256_mullo_epi32(velocity, scales)));
+            }
+        }
+#elif defined(__SSE2__) && !defined(ECS_NO_SIMD)
+        if constexpr(std::is_same_v<Lane, float>) {
+            __m128 scales = _mm_set1_ps(scale);
+            for(; lane + 4 <= lane_count; lane += 4) {
+                __m128 position = _mm_loadu_ps(position_lanes + lane);
+                __m128 velocity = _mm_loadu_ps(velocity_lanes + lane);
+                _mm_storeu_ps(position_lanes + lane, _mm_add_ps(position, _mm_mul_ps(velocity, scales)));
+            }
+        } else if(scale == 1) {
+            for(; lane + 4 <= lane_count; lane += 4) {
+                __m128i position = _mm_loadu_si128((const __m128i*)(position_lanes + lane));
+                __m128i velocity = _mm_loadu_si128((const __m128i*)(velocity_lanes + lane));
+                _mm_storeu_si128((__m128i*)(position_lanes + lane), _mm_add_epi32(position, velocity));
+            }
+        }
+#endif
+        for(; lane < lane_count; lane++) {
+            position_lanes[lane] += velocity_lanes[lane] * scale;
+        }
+    }
+
+    // Clamps each position between the minimum and the maximum, per axis. Vectorized like integrate_vec2(), except
+    // that ints are only vectorized with AVX2.
+    template<Vec2Component V>
+    void clamp_vec2(std::span<V> positions, const V& minimum, const V& maximum) {
+        using Lane = decltype(V::x);
+        Lane* position_lanes = reinterpret_cast<Lane*>(positions.data());
+        std::size_t lane_count = positions.size() * 2;
+        std::size_t lane = 0;
+#if defined(__AVX2__) && !defined(ECS_NO_SIMD)
+        if constexpr(std::is_same_v<Lane, float>) {
+            __m256 minimums = _mm256_setr_ps(minimum.x, minimum.y, minimum.x, minimum.y, minimum.x, minimum.y, minimum.x, minimum.y);
+            __m256 maximums = _mm256_setr_ps(maximum.x, maximum.y, maximum.x, maximum.y, maximum.x, maximum.y, maximum.x, maximum.y);
+            for(; lane + 8 <= lane_count; lane += 8) {
+                __m256 position = _mm256_loadu_ps(position_lanes + lane);
+                _mm256_storeu_ps(position_lanes + lane, _mm256_min_ps(_mm256_max_ps(position, minimums), maximums));
+            }
+        } else {
+            __m256i minimums = _mm256_setr_epi32(minimum.x, minimum.y, minimum.x, minimum.y, minimum.x, minimum.y, minimum.x, minimum.y);
+            __m256i maximums = _mm256_setr_epi32(maximum.x, maximum.y, maximum.x, maximum.y, maximum.x, maximum.y, maximum.x, maximum.y);
+            for(; lane + 8 <= lane_count; lane += 8) {
+                __m256i position = _mm256_loadu_si256((const __m256i*)(position_lanes + lane));
+                _mm256_storeu_si256((__m256i*)(position_lanes + lane), _mm256_min_epi32(_mm256_max_epi32(position, minimums), maximums));
+            }
+        }
+#elif defined(__SSE2__) && !defined(ECS_NO_SIMD)
+        if constexpr(std::is_same_v<Lane, float>) {
+            __m128 minimums = _mm_setr_ps(minimum.x, minimum.y, minimum.x, minimum.y);
+            __m128 maximums = _mm_setr_ps(maximum.x, maximum.y, maximum.x, maximum.y);
+            for(; lane + 4 <= lane_count; lane += 4) {
+                __m128 position = _mm_loadu_ps(position_lanes + lane);
+                _mm_storeu_ps(position_lanes + lane, _mm_min_ps(_mm_max_ps(position, minimums), maximums));
+            }
+        }
+#endif
+        // Even lanes are x and odd lanes are y
+        for(; lane < lane_count; lane++) {
+            Lane lane_minimum = lane % 2 == 0 ? minimum.x : minimum.y;
+            Lane lane_maximum = lane % 2 == 0 ? maximum.x : maximum.y;
+            position_lanes[lane] = std::min(std::max(position_lanes[lane], lane_minimum), lane_maximum);
+        }
+    }
+
+    // An axis aligned box. Boxes which only touch don't intersect.
+    struct Bounds {
+        float min_x;
+        float min_y;
+        float max_x;
+        float max_y;
+
+        bool intersects(const Bounds& other) const {
+            return min_x < other.max_x && other.min_x < max_x && min_y < other.max_y && other.min_y < max_y;
+        }
+    };
+
+    // A broad phase index over the entities with a component of type T, which the bounds function maps to a box. The
+    // grid splits the plane into square cells and lists each entity in every cell its box overlaps, so queries only
+    // look at the entities in the cells they cover. Only the cells which were ever occupied are stored, so the world
+    // doesn't need to have a fixed size. The cell size should be around the size of a typical box.
+    //
+    // update() brings the grid in line with the world, and is meant to run once per frame as a system which reads T,
+    // ordered before the systems which query the grid. It only computes the boxes of components which were added or
+    // accessed mutably since the tick of the last update, and only looks for removed components when the grid holds
+    // an entity which the array doesn't. Entities whose box stays in the same cells aren't moved. Queries see the world
+    // as of the last update, so entities can be removed from the world from within a query.
+    //     ecs::SpatialGrid<Collider> grid(my_ecs, 64.0f, [](const Collider& collider) { return collider.bounds; });
+    //     scheduler.add_system<ecs::Reads<Collider>>([&grid](ecs::ECS&) { grid.update(); });
+    template<typename T>
+    class SpatialGrid {
+        public:
+            SpatialGrid(ECS& ecs, float cell_size, std::function<Bounds(const T&)> get_bounds) :
+                ecs(ecs),
+                cell_size(cell_size),
+                get_bounds(std::move(get_bounds)),
+                entity_set(ecs.get_memory_resource()),
+                ranges(ecs.get_memory_resource()),
+                cells(ecs.get_memory_resource()),
+                cell_slots(ecs.get_memory_resource()),
+                changed_positions(ecs.get_memory_resource()) {
+                ecs_assert(cell_size > 0.0f, "Cannot create spatial grid. Cell size must be positive.");
+            }
+
+            void update() {
+                const ComponentArray<T>& component_array = ecs.storage<T>();
+                const std::pmr::vector<Entity>& entities = component_array.entities();
+                const std::pmr::vector<Tick>& changed_ticks = component_array.get_changed_ticks();
+
+                // Components which haven't changed since the last update were in the array back then, and so are in
+                // the grid. The grid can only end up holding more entities than the array if some were removed.
+                changed_positions.clear();
+                std::size_t added_count = 0;
+                for(std::uint32_t position = 0; position < changed_ticks.size(); position++) {
+                    if(changed_ticks[position] >= synced_tick) {
+                        changed_positions.push_back(position);
+                        added_count += !entity_set.contains(entities[position]);
+                    }
+                }
+                if(entity_set.size() + added_count > entities.size()) {
+                    remove_stale(component_array);
+                }
+
+                for(std::uint32_t position : changed_positions) {
+                    place(entities[position], get_bounds(component_array.value_at(position)));
+                }
+                synced_tick = ecs.get_tick();
+            }
+
+            // Calls the function once per entity whose box intersects the area
+            template<typename Function>
+            void query_rect(const Bounds& area, Function function) const {
+                CellRange area_range = cells_of(area);
+                for(std::int32_t y = area_range.min_y; y <= area_range.max_y; y++) {
+                    for(std::int32_t x = area_range.min_x; x <= area_range.max_x; x++) {
+                        std::uint32_t cell = find_cell(cell_key(x, y));
+                        if(cell == NO_CELL) {
+                            continue;
+                        }
+
+                        for(const CellEntry& entry : cells[cell].entries) {
+                            if(is_first_shared_cell(x, y, entry, area_range) && entry.box.intersects(area)) {
+                                function(entry.entity);
+                            }
+                        }
+                    }
+                }
+            }
+
+            // Calls the function once per pair of entities whose boxes intersect each other
+            template<typename Function>
+            void query_pairs(Function function) const {
+                for(const Cell& cell : cells) {
+                    const std::pmr::vector<CellEntry>& cell_entries = cell.entries;
+                    std::int32_t x = (std::int32_t)(cell.key >> 32);
+                    std::int32_t y = (std::int32_t)(std::uint32_t)cell.key;
+                    for(std::size_t a = 0; a < cell_entries.size(); a++) {
+                        for(std::size_t b = a + 1; b < cell_entries.size(); b++) {
+                            if(is_first_shared_cell(x, y, cell_entries[a], cell_entries[b]) && cell_entries[a].box.intersects(cell_entries[b].box)) {
+                                function(cell_entries[a].entity, cell_entries[b].entity);
+                            }
+                        }
+                    }
+                }
+            }
+
+            bool contains(Entity entity) const {
+                return entity_set.contains(entity);
+            }
+
+            std::size_t size() const {
+                return entity_set.size();
+            }
+        private:
+            // The cells a box overlaps, inclusive on both ends
+            struct CellRange {
+                std::int32_t min_x;
+                std::int32_t min_y;
+                std::int32_t max_x;
+                std::int32_t max_y;
+
+                bool operator==(const CellRange& other) const = default;
+            };
+
+            // Each cell keeps a copy of its entities' boxes and first cells, so queries don't have to look them up
+            struct CellEntry {
+                Entity entity;
+                std::int32_t min_x;
+                std::int32_t min_y;
+                Bounds box;
+            };
+
+            ECS& ecs;
+            float cell_size;
+            std::function<Bounds(const T&)> get_bounds;
+
+            // The entities in the grid, with their cell ranges in a parallel array
+            SparseSet entity_set;
+            std::pmr::vector<CellRange> ranges;
+
+            struct Cell {
+                std::uint64_t key;
+                std::pmr::vector<CellEntry> entries;
+            };
+
+            // The occupied cells are kept in one array, so query_pairs() sweeps it in order, and are found through an
+            // open addressed table of indices into it. A cell which empties out stays, ready for the next entity.
+            static constexpr std::uint32_t NO_CELL = std::numeric_limits<std::uint32_t>::max();
+            std::pmr::vector<Cell> cells;
+            std::pmr::vector<std::uint32_t> cell_slots;
+
+            // Components changed at or after this tick haven't been seen by the grid yet
+            Tick synced_tick = 0;
+            std::pmr::vector<std::uint32_t> changed_positions;
+
+            static std::uint64_t cell_key(std::int32_t x, std::int32_t y) {
+                return ((std::uint64_t)(std::uint32_t)x << 32) | (std::uint32_t)y;
+            }
+
+            // Two intersecting boxes share a block of cells. Only reporting them from its first cell reports them once.
+            template<typename A, typename B>
+            static bool is_first_shared_cell(std::int32_t x, std::int32_t y, const A& a, const B& b) {
+                return x == std::max(a.min_x, b.min_x) && y == std::max(a.min_y, b.min_y);
+            }
+
+            static std::size_t cell_hash(std::uint64_t key) {
+                return (std::size_t)((key * 0x9E3779B97F4A7C15ull) >> 32);
+            }
+
+            std::uint32_t find_cell(std::uint64_t key) const {
+                if(cell_slots.empty()) {
+                    return NO_CELL;
+                }
+
+                std::size_t mask = cell_slots.size() - 1;
+                for(std::size_t slot = cell_hash(key) & mask;; slot = (slot + 1) & mask) {
+                    std::uint32_t cell = cell_slots[slot];
+                    if(cell == NO_CELL || cells[cell].key == key) {
+                        return cell;
+                    }
+                }
+            }
+
+            std::uint32_t find_or_add_cell(std::uint64_t key) {
+                std::uint32_t cell = find_cell(key);
+                if(cell != NO_CELL) {
+                    return cell;
+                }
+
+                // Keep the table at most half full
+                if((cells.size() + 1) * 2 > cell_slots.size()) {
+                    cell_slots.assign(std::max<std::size_t>(64, cell_slots.size() * 2), NO_CELL);
+                    for(std::uint32_t existing = 0; existing < cells.size(); existing++) {
+                        insert_cell_slot(cells[existing].key, existing);
+                    }
+                }
+
+                cell = (std::uint32_t)cells.size();
+                cells.push_back((Cell) { .key = key, .entries = std::pmr::vector<CellEntry>(cells.get_allocator()) });
+                insert_cell_slot(key, cell);
+                return cell;
+            }
+
+            void insert_cell_slot(std::uint64_t key, std::uint32_t cell) {
+                std::size_t mask = cell_slots.size() - 1;
+                std::size_t slot = cell_hash(key) & mask;
+                while(cell_slots[slot] != NO_CELL) {
+                    slot = (slot + 1) & mask;
+                }
+                cell_slots[slot] = cell;
+            }
+
+            CellRange cells_of(const Bounds& box) const {
+                return (CellRange) {
+                    .min_x = (std::int32_t)std::floor(box.min_x / cell_size),
+                    .min_y = (std::int32_t)std::floor(box.min_y / cell_size),
+                    .max_x = (std::int32_t)std::floor(box.max_x / cell_size),
+                    .max_y = (std::int32_t)std::floor(box.max_y / cell_size)
+                };
+            }
+
+            void place(Entity entity, const Bounds& box) {
+                CellRange range = cells_of(box);
+                if(entity_set.contains(entity)) {
+                    std::uint32_t index = entity_set.index_of(entity);
+                    if(ranges[index] == range) {
+                        // Same cells, only the copies of the box need updating
+                        for_each_entry(entity, range, [&box](std::pmr::vector<CellEntry>&, CellEntry& entry) {
+                            entry.box = box;
+                        });
+                        return;
+                    }
+
+                    remove_from_cells(entity, ranges[index]);
+                    ranges[index] = range;
+                } else {
+                    entity_set.insert(entity);
+                    ranges.push_back(range);
+                }
+
+                for(std::int32_t y = range.min_y; y <= range.max_y; y++) {
+                    for(std::int32_t x = range.min_x; x <= range.max_x; x++) {
+                        cells[find_or_add_cell(cell_key(x, y))].entries.push_back((CellEntry) { .entity = entity, .min_x = range.min_x, .min_y = range.min_y, .box = box });
+                    }
+                }
+            }
+
+            void remove_from_cells(Entity entity, const CellRange& range) {
+                for_each_entry(entity, range, [](std::pmr::vector<CellEntry>& cell_entries, CellEntry& entry) {
+                    entry = cell_entries.back();
+                    cell_entries.pop_back();
+                });
+            }
+
+            // Calls the function with the entity's entry in each cell of the range
+            template<typename Function>
+            void for_each_entry(Entity entity, const CellRange& range, Function function) {
+                for(std::int32_t y = range.min_y; y <= range.max_y; y++) {
+                    for(std::int32_t x = range.min_x; x <= range.max_x; x++) {
+                        std::pmr::vector<CellEntry>& cell_entries = cells[find_cell(cell_key(x, y))].entries;
+                        auto entry = std::find_if(cell_entries.begin(), cell_entries.end(), [entity](const CellEntry& entry) {
+                            return entry.entity == entity;
+                        });
+                        function(cell_entries, *entry);
+                    }
+                }
+            }
+
+            // Walks the grid from the back, so the entity swapped into a removed entity's place was already checked.
+            // Stale entities go before new ones are placed, since a new entity may reuse a stale entity's slot.
+            void remove_stale(const ComponentArray<T>& component_array) {
+                for(std::uint32_t index = (std::uint32_t)entity_set.size(); index-- > 0;) {
+                    Entity entity = entity_set.entities()[index];
+                    if(component_array.has_component(entity)) {
+                        continue;
+                    }
+
+                    remove_from_cells(entity, ranges[index]);
+                    entity_set.remove(entity);
+                    ranges[index] = ranges.back();
+                    ranges.pop_back();
+                }
+            }
     };
 };